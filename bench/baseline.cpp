@@ -0,0 +1,152 @@
+#include "baseline.h"
+
+#include <iostream>
+
+#include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace
+{
+    // bump when the meaning of a field changes, old baselines are then rejected instead of misread
+    constexpr int format_version = 1;
+
+    double ns_per_item(const PhaseResult& r)
+    {
+        return r.items ? r.seconds * 1e9 / static_cast<double>(r.items) : 0.0;
+    }
+
+    struct Metric
+    {
+        const char* name;
+        double baseline;
+        double current;
+    };
+
+    bool check(const std::string& phase, const Metric& m, const double threshold_percent)
+    {
+        const double change = m.baseline > 0.0 ? (m.current - m.baseline) / m.baseline * 100.0 : 0.0;
+        const bool regressed = change > threshold_percent;
+
+        llvm::outs() << llvm::format("%-22s %-12s %14.2f %14.2f %+9.1f%%", phase.c_str(), m.name, m.baseline,
+                                     m.current, change)
+                     << (regressed ? "  REGRESSED" : "") << "\n";
+        return !regressed;
+    }
+}
+
+bool write_bench_json(const std::string& path, const BenchRun& run)
+{
+    std::error_code ec;
+    llvm::raw_fd_ostream out(path, ec);
+    if (ec)
+    {
+        std::cerr << "minic-bench: couldn't write " << path << ": " << ec.message() << "\n";
+        return false;
+    }
+
+    llvm::json::OStream json(out, 2);
+    json.object([&]
+    {
+        json.attribute("format", format_version);
+        json.attribute("iterations", static_cast<int64_t>(run.iterations));
+        json.attribute("rounds", static_cast<int64_t>(run.rounds));
+        json.attributeArray("corpus", [&]
+        {
+            for (const auto& file : run.corpus) json.value(file);
+        });
+        json.attribute("peak_rss_bytes", static_cast<int64_t>(run.peak_rss));
+        json.attributeArray("phases", [&]
+        {
+            for (std::size_t i = 0; i < run.timings.size(); ++i)
+            {
+                const auto& t = run.timings[i];
+                json.object([&]
+                {
+                    json.attribute("name", t.name);
+                    json.attribute("unit", t.unit);
+                    json.attribute("items", static_cast<int64_t>(t.items));
+                    json.attribute("seconds", t.seconds);
+                    json.attribute("ns_per_item", ns_per_item(t));
+                    json.attribute("allocations", static_cast<int64_t>(run.memory[i].allocations));
+                    json.attribute("bytes", static_cast<int64_t>(run.memory[i].bytes));
+                });
+            }
+        });
+    });
+    out << "\n";
+    return true;
+}
+
+bool compare_with_baseline(const std::string& path, const BenchRun& run, const double threshold_percent)
+{
+    auto buffer = llvm::MemoryBuffer::getFile(path);
+    if (!buffer)
+    {
+        std::cerr << "minic-bench: couldn't read baseline " << path << ": " << buffer.getError().message() << "\n";
+        return false;
+    }
+
+    auto parsed = llvm::json::parse((*buffer)->getBuffer());
+    if (!parsed)
+    {
+        std::cerr << "minic-bench: " << path << " is not valid JSON: " << llvm::toString(parsed.takeError()) << "\n";
+        return false;
+    }
+
+    const auto* root = parsed->getAsObject();
+    const auto* phases = root ? root->getArray("phases") : nullptr;
+    if (!phases || root->getInteger("format").getValueOr(0) != format_version)
+    {
+        std::cerr << "minic-bench: " << path << " is not a format " << format_version << " minic-bench baseline\n";
+        return false;
+    }
+
+    // per-item times still compare across corpora, but allocation totals don't
+    std::vector<std::string> base_corpus;
+    if (const auto* files = root->getArray("corpus"))
+    {
+        for (const auto& f : *files)
+        {
+            if (auto name = f.getAsString()) base_corpus.push_back(name->str());
+        }
+    }
+    if (base_corpus != run.corpus)
+    {
+        llvm::outs() << "warning: the baseline was taken over a different corpus\n";
+    }
+
+    llvm::outs() << llvm::format("%-22s %-12s %14s %14s %10s", static_cast<const char*>("phase"),
+                                 static_cast<const char*>("metric"), static_cast<const char*>("baseline"),
+                                 static_cast<const char*>("current"), static_cast<const char*>("change"))
+                 << "\n";
+
+    bool ok = true;
+    for (std::size_t i = 0; i < run.timings.size(); ++i)
+    {
+        const auto& t = run.timings[i];
+        const llvm::json::Object* base = nullptr;
+        for (const auto& p : *phases)
+        {
+            const auto* obj = p.getAsObject();
+            if (obj && obj->getString("name") == llvm::StringRef(t.name)) base = obj;
+        }
+
+        if (!base)
+        {
+            llvm::outs() << t.name << ": not in the baseline, skipped\n";
+            continue;
+        }
+
+        ok &= check(t.name, {"ns/item", base->getNumber("ns_per_item").getValueOr(0.0), ns_per_item(t)}, threshold_percent);
+        ok &= check(t.name, {"allocations", static_cast<double>(base->getInteger("allocations").getValueOr(0)),
+                             static_cast<double>(run.memory[i].allocations)}, threshold_percent);
+        ok &= check(t.name, {"bytes", static_cast<double>(base->getInteger("bytes").getValueOr(0)),
+                             static_cast<double>(run.memory[i].bytes)}, threshold_percent);
+    }
+
+    llvm::outs() << (ok ? "no regressions" : "regressions") << llvm::format(" beyond %.1f%% against ", threshold_percent)
+                 << path << "\n";
+    return ok;
+}
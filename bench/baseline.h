@@ -0,0 +1,26 @@
+#ifndef BENCH_BASELINE_H
+#define BENCH_BASELINE_H
+
+#include <string>
+#include <vector>
+
+#include "pipeline.h"
+
+// one minic-bench run, as written to and compared against a JSON baseline
+struct BenchRun
+{
+    std::vector<std::string> corpus;
+    std::size_t iterations = 0;
+    std::size_t rounds = 0;
+    std::vector<PhaseResult> timings; // fastest round, each round being `iterations` passes over the corpus
+    std::vector<PhaseResult> memory;  // one pass over the corpus with allocation counting on
+    std::size_t peak_rss = 0;
+};
+
+bool write_bench_json(const std::string& path, const BenchRun& run);
+
+// prints a per-phase comparison; false if any phase got slower (per item) or allocated more than
+// threshold_percent over the baseline, or the baseline couldn't be read
+bool compare_with_baseline(const std::string& path, const BenchRun& run, double threshold_percent);
+
+#endif // BENCH_BASELINE_H
@@ -0,0 +1,152 @@
+// per-phase throughput benchmark for the mini-c pipeline
+// usage: minic-bench [--iterations N] [--rounds N] [--json file] [--baseline file [--threshold percent]]
+//                    [source-files...] (defaults to the files in bench/corpus)
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "baseline.h"
+#include "memstats.h"
+#include "pipeline.h"
+
+namespace
+{
+    struct CorpusFile
+    {
+        std::string path;
+        std::string contents;
+    };
+
+    std::vector<CorpusFile> load_corpus(const std::vector<std::string>& paths)
+    {
+        std::vector<CorpusFile> corpus;
+        for (const auto& path : paths)
+        {
+            std::ifstream in(path);
+            if (!in.is_open())
+            {
+                std::cerr << "minic-bench: couldn't open " << path << "\n";
+                continue;
+            }
+            corpus.push_back({path, (std::ostringstream() << in.rdbuf()).str()});
+        }
+        return corpus;
+    }
+}
+
+static const char* usage =
+    "Usage: minic-bench [--iterations N] [--rounds N] [--json file] [--baseline file [--threshold percent]] [source-files...]\n";
+
+int main(int argc, char* argv[])
+{
+    std::size_t iterations = 200;
+    std::size_t rounds = 3;
+    double threshold = 5.0;
+    std::string json_path, baseline_path;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--iterations" && has_value) iterations = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--rounds" && has_value) rounds = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--json" && has_value) json_path = argv[++i];
+        else if (arg == "--baseline" && has_value) baseline_path = argv[++i];
+        else if (arg == "--threshold" && has_value) threshold = std::strtod(argv[++i], nullptr);
+        else if (arg.starts_with("--"))
+        {
+            std::cerr << usage;
+            return 1;
+        }
+        else paths.push_back(arg);
+    }
+
+    if (paths.empty())
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(MINIC_BENCH_CORPUS))
+        {
+            if (entry.path().extension() == ".c") paths.push_back(entry.path().string());
+        }
+        std::sort(paths.begin(), paths.end());
+    }
+
+    const auto corpus = load_corpus(paths);
+    if (corpus.empty() || iterations == 0 || rounds == 0)
+    {
+        std::cerr << usage;
+        return 1;
+    }
+
+    BenchRun run;
+    run.iterations = iterations;
+    run.rounds = rounds;
+    for (const auto& file : corpus)
+    {
+        // just the names, so baselines compare across checkouts
+        run.corpus.push_back(std::filesystem::path(file.path).filename().string());
+    }
+
+    // keep the fastest round of each phase, the others mostly measure noise
+    for (std::size_t r = 0; r < rounds; ++r)
+    {
+        auto results = make_phase_results();
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            for (const auto& file : corpus)
+            {
+                if (!run_pipeline(file.path, file.contents, results)) return 1;
+            }
+        }
+
+        if (r == 0) run.timings = results;
+        for (std::size_t p = 0; p < results.size(); ++p)
+        {
+            if (results[p].seconds < run.timings[p].seconds) run.timings[p] = results[p];
+        }
+    }
+
+    // allocations are counted in a separate, untimed pass so the counting doesn't skew the timings
+    run.memory = make_phase_results();
+    set_allocation_counting(true);
+    for (const auto& file : corpus)
+    {
+        if (!run_pipeline(file.path, file.contents, run.memory)) return 1;
+    }
+    set_allocation_counting(false);
+    run.peak_rss = get_peak_rss();
+
+    std::size_t bytes = 0;
+    for (const auto& file : corpus) bytes += file.contents.size();
+
+    std::cout << "corpus: " << corpus.size() << " files, " << bytes << " bytes, "
+              << iterations << " iterations, best of " << rounds << " rounds\n\n";
+    for (std::size_t p = 0; p < run.timings.size(); ++p)
+    {
+        // report the allocations of one pass next to the timings
+        run.timings[p].allocations = run.memory[p].allocations;
+        run.timings[p].bytes = run.memory[p].bytes;
+    }
+    print_phase_results(run.timings);
+    std::cout << "\npeak RSS: " << run.peak_rss / 1024 << " KiB\n";
+
+    if (!json_path.empty() && !write_bench_json(json_path, run))
+    {
+        return 1;
+    }
+
+    if (!baseline_path.empty())
+    {
+        std::cout << "\n";
+        std::cout.flush();
+        return compare_with_baseline(baseline_path, run, threshold) ? 0 : 1;
+    }
+
+    return 0;
+}
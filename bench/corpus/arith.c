@@ -0,0 +1,45 @@
+int sum3(int a, int b, int c)
+{
+	return a + b + c;
+}
+
+int diff(int a, int b)
+{
+	int d = a - b;
+	return d;
+}
+
+int clamp(int v, int lo, int hi)
+{
+	int r = v;
+	if (r < lo) {
+		r = lo;
+	} else {
+		r = r;
+	}
+	if (r > hi) {
+		r = hi;
+	} else {
+		r = r;
+	}
+	return r;
+}
+
+int triangle(int n)
+{
+	int i = 0;
+	int acc = 0;
+	while (i <= n) {
+		acc = acc + i;
+		i = i + 1;
+	}
+	return acc;
+}
+
+int main() {
+	int x = sum3(1, 2, 3);
+	int y = diff(x, 4);
+	int z = clamp(y, 0 - 10, 10);
+	int t = triangle(z + 100);
+	return t - x + y - z;
+}
@@ -0,0 +1,43 @@
+int id(int x)
+{
+	return x;
+}
+
+int inc(int x)
+{
+	return id(x) + 1;
+}
+
+int dec(int x)
+{
+	return id(x) - 1;
+}
+
+int add(int a, int b)
+{
+	return inc(a) + dec(b);
+}
+
+int pick(int c, int a, int b)
+{
+	int r = 0;
+	if (c != 0) {
+		r = id(a);
+	} else {
+		r = id(b);
+	}
+	return r;
+}
+
+int chain(int a, int b, int c, int d)
+{
+	int s = add(add(a, b), add(c, d));
+	int t = pick(s >= 10, inc(s), dec(s));
+	return add(s, t) - pick(t <= 0, a, d);
+}
+
+int main() {
+	printf("calls");
+	int v = chain(1, 2, 3, 4);
+	return v - chain(4, 3, 2, 1);
+}
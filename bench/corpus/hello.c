@@ -0,0 +1,17 @@
+
+int add(int a, int b, int c)
+{
+	printf("Fooo.....");
+	return a + b + c;
+}
+
+
+int main() {
+	int q = add(1, 2, 1); 
+	int i = 0; 
+	while (i <= q) {
+		printf("Hello.");
+		i = i + 1;
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+int countup(int limit)
+{
+	int i = 0;
+	int evens = 0;
+	while (i < limit) {
+		int half = i - i + 0;
+		if (i == half) {
+			evens = evens + 1;
+		} else {
+			evens = evens - 0;
+		}
+		i = i + 1;
+	}
+	return evens;
+}
+
+int nested(int rows, int cols)
+{
+	int r = 0;
+	int cells = 0;
+	while (r < rows) {
+		int c = 0;
+		while (c < cols) {
+			cells = cells + 1;
+			c = c + 1;
+		}
+		r = r + 1;
+	}
+	return cells;
+}
+
+int main() {
+	printf("==== loops ====");
+	int a = countup(100);
+	int b = nested(10, 20);
+	while (a != b) {
+		printf("not equal yet");
+		a = a + 1;
+	}
+	return a - b;
+}
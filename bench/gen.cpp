@@ -0,0 +1,54 @@
+// writes a synthetic mini-c program to stdout (or -o file)
+// usage: minic-gen [--functions N] [--locals N] [--depth N] [--expression-size N] [--seed N] [-o file]
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "generator.h"
+
+int main(int argc, char* argv[])
+{
+    GeneratorOptions options;
+    std::string output;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            std::cerr << "minic-gen: missing value for " << arg << "\n";
+            return 1;
+        }
+
+        const char* value = argv[++i];
+        if (arg == "--functions") options.functions = std::strtoull(value, nullptr, 10);
+        else if (arg == "--locals") options.locals = std::strtoull(value, nullptr, 10);
+        else if (arg == "--depth") options.depth = std::strtoull(value, nullptr, 10);
+        else if (arg == "--expression-size") options.expression_size = std::strtoull(value, nullptr, 10);
+        else if (arg == "--seed") options.seed = std::strtoull(value, nullptr, 10);
+        else if (arg == "-o") output = value;
+        else
+        {
+            std::cerr << "Usage: minic-gen [--functions N] [--locals N] [--depth N] [--expression-size N] [--seed N] [-o file]\n";
+            return 1;
+        }
+    }
+
+    if (output.empty())
+    {
+        std::ios::sync_with_stdio(false);
+        generate_program(options, std::cout);
+        return 0;
+    }
+
+    std::ofstream out(output, std::ios::binary);
+    if (!out.is_open())
+    {
+        std::cerr << "minic-gen: couldn't open " << output << "\n";
+        return 1;
+    }
+    generate_program(options, out);
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include "generator.h"
+
+#include <random>
+#include <string>
+
+namespace
+{
+    class ProgramWriter
+    {
+    public:
+        ProgramWriter(const GeneratorOptions& options, std::ostream& out)
+            : options(options), out(out), rng(options.seed)
+        {
+        }
+
+        void function(std::size_t index)
+        {
+            current_function = index;
+            live_locals = 0;
+
+            out << "int f" << index << "(int a, int b)\n{\n";
+            for (std::size_t i = 0; i < options.locals; ++i)
+            {
+                indent(1);
+                out << "int v" << i << " = ";
+                expression();
+                out << ";\n";
+                ++live_locals;
+            }
+
+            nested(1, options.depth);
+
+            indent(1);
+            out << "return ";
+            expression();
+            out << ";\n}\n\n";
+        }
+
+        void main_function()
+        {
+            out << "int main() {\n";
+            indent(1);
+            out << "int r = f" << options.functions - 1 << "(1, 2);\n";
+            indent(1);
+            out << "return r;\n}\n";
+        }
+
+    private:
+        // one while loop or if/else per level, each declaring a block-local of its own
+        void nested(std::size_t level, std::size_t remaining)
+        {
+            if (remaining == 0) return;
+
+            const bool loop = pick(2) == 0;
+            indent(level);
+            out << (loop ? "while (" : "if (");
+            operand();
+            out << (loop ? " < " : " != ");
+            operand();
+            out << ") {\n";
+            body(level + 1, remaining - 1);
+            indent(level);
+            out << "}";
+
+            if (!loop)
+            {
+                // only one branch nests further, so the program stays linear in the depth
+                out << " else {\n";
+                body(level + 1, 0);
+                indent(level);
+                out << "}";
+            }
+            out << "\n";
+        }
+
+        void body(std::size_t level, std::size_t remaining)
+        {
+            // block-locals are named by depth, so sibling blocks can reuse the name
+            indent(level);
+            out << "int w" << level << " = ";
+            expression();
+            out << ";\n";
+
+            indent(level);
+            if (options.locals > 0)
+            {
+                out << "v" << pick(options.locals);
+            }
+            else
+            {
+                out << "w" << level;
+            }
+            out << " = ";
+            expression();
+            out << ";\n";
+
+            if (pick(4) == 0)
+            {
+                indent(level);
+                out << "printf(\"f" << current_function << " level " << level << "\");\n";
+            }
+
+            nested(level, remaining);
+        }
+
+        void expression()
+        {
+            const std::size_t operands = options.expression_size == 0 ? 1 : options.expression_size;
+            operand();
+            for (std::size_t i = 1; i < operands; ++i)
+            {
+                static const char* ops[] = {" + ", " - ", " + ", " - ", " < ", " == "};
+                out << ops[pick(sizeof(ops) / sizeof(*ops))];
+                operand();
+            }
+        }
+
+        void operand()
+        {
+            switch (pick(current_function > 0 ? 5 : 4))
+            {
+            case 0: out << "a"; break;
+            case 1: out << "b"; break;
+            case 2: out << pick(1000); break;
+            case 3:
+                if (live_locals > 0)
+                {
+                    out << "v" << pick(live_locals);
+                }
+                else
+                {
+                    out << pick(10);
+                }
+                break;
+            default:
+                // only earlier functions are visible to the analyzer
+                out << "f" << pick(current_function) << "(";
+                out << (pick(2) ? "a" : "b") << ", " << pick(100) << ")";
+                break;
+            }
+        }
+
+        std::size_t pick(std::size_t bound)
+        {
+            return static_cast<std::size_t>(rng() % bound);
+        }
+
+        void indent(std::size_t level)
+        {
+            // capped, otherwise whitespace grows quadratically with the depth and swamps the size
+            for (std::size_t i = 0; i < level && i < 8; ++i) out << '\t';
+        }
+
+    private:
+        const GeneratorOptions& options;
+        std::ostream& out;
+        std::mt19937_64 rng;
+        std::size_t current_function = 0;
+        std::size_t live_locals = 0;
+    };
+}
+
+void generate_program(const GeneratorOptions& options, std::ostream& out)
+{
+    ProgramWriter writer(options, out);
+    for (std::size_t i = 0; i < options.functions; ++i)
+    {
+        writer.function(i);
+    }
+
+    if (options.functions > 0)
+    {
+        writer.main_function();
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef BENCH_GENERATOR_H
+#define BENCH_GENERATOR_H
+
+#include <cstdint>
+#include <ostream>
+
+// emits synthetic (but valid: it lexes, parses, analyzes and verifies) mini-c translation units
+struct GeneratorOptions
+{
+    std::size_t functions = 100;       // top-level functions, plus a main that calls the last one
+    std::size_t locals = 8;            // int locals declared at the top of each function
+    std::size_t depth = 2;             // nesting depth of the while/if-else statements in each function
+    std::size_t expression_size = 6;   // operands per generated expression
+    std::uint64_t seed = 1;
+};
+
+// streams the program out, so the size is only limited by the destination
+void generate_program(const GeneratorOptions& options, std::ostream& out);
+
+#endif // BENCH_GENERATOR_H
@@ -0,0 +1,134 @@
+#include "pipeline.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+
+#include "compiler.h"
+#include "error.h"
+#include "lexer.h"
+#include "memstats.h"
+#include "parser.h"
+#include "semanalyzer.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // times one phase and attributes the allocations it made to it
+    class PhaseMeasurement
+    {
+    public:
+        explicit PhaseMeasurement(PhaseResult& result)
+            : result(result), allocated(get_allocation_counters()), start(Clock::now())
+        {
+        }
+
+        ~PhaseMeasurement()
+        {
+            result.seconds += std::chrono::duration<double>(Clock::now() - start).count();
+            const auto now = get_allocation_counters();
+            result.allocations += now.allocations - allocated.allocations;
+            result.bytes += now.bytes - allocated.bytes;
+        }
+
+    private:
+        PhaseResult& result;
+        AllocationCounters allocated;
+        Clock::time_point start;
+    };
+
+    std::size_t count_ir_instructions(const llvm::Module& mod)
+    {
+        std::size_t n = 0;
+        for (const auto& f : mod)
+        {
+            n += f.getInstructionCount();
+        }
+        return n;
+    }
+}
+
+std::vector<PhaseResult> make_phase_results()
+{
+    return {
+        {"Lexer::lex", "tokens"},
+        {"Parser::get_program", "AST nodes"},
+        {"SemanticAnalyzer", "functions"},
+        {"Codegen", "IR instructions"},
+    };
+}
+
+bool run_pipeline(const std::string& name, const std::string& source, std::vector<PhaseResult>& results)
+{
+    // constructed inside the measurements, setting up is part of the phase's cost
+    std::optional<Interner> names;
+    std::optional<Lexer> lexer;
+    {
+        PhaseMeasurement phase(results[PHASE_LEX]);
+        names.emplace();
+        lexer.emplace(source, *names);
+        lexer->lex();
+    }
+    results[PHASE_LEX].items += lexer->get_tokens().size();
+
+    Parser parser(lexer->get_tokens());
+    Parser::Program program;
+    {
+        PhaseMeasurement phase(results[PHASE_PARSE]);
+        program = parser.get_program();
+    }
+
+    if (get_err() == ErrorMode::ERR)
+    {
+        std::cerr << name << ": does not lex/parse cleanly\n";
+        return false;
+    }
+
+    NodeCounter counter;
+    counter.count(program);
+    results[PHASE_PARSE].items += counter.total();
+
+    {
+        PhaseMeasurement phase(results[PHASE_SEMA]);
+        SemanticAnalyzer analyzer(program.nodes, *names, lexer->get_lines());
+        for (auto& d : program)
+        {
+            auto [ok, rich] = analyzer.perform_analysis(d);
+            if (!ok)
+            {
+                std::cerr << name << ": failed semantic analysis\n";
+                return false;
+            }
+            d = std::move(rich);
+        }
+    }
+    results[PHASE_SEMA].items += program.size();
+
+    std::optional<Codegen> gen;
+    {
+        PhaseMeasurement phase(results[PHASE_CODEGEN]);
+        gen.emplace(*names);
+        gen->generate_translation_unit(program);
+    }
+    results[PHASE_CODEGEN].items += count_ir_instructions(gen->get_module());
+
+    return true;
+}
+
+void print_phase_results(const std::vector<PhaseResult>& results)
+{
+    std::cout << std::left << std::setw(22) << "phase" << std::right << std::setw(12) << "time (ms)"
+              << std::setw(14) << "items" << std::setw(16) << "items/sec" << std::setw(14) << "allocations"
+              << std::setw(14) << "bytes" << "  unit\n";
+
+    for (const auto& r : results)
+    {
+        const double per_sec = r.seconds > 0.0 ? static_cast<double>(r.items) / r.seconds : 0.0;
+        std::cout << std::left << std::setw(22) << r.name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << r.seconds * 1000.0 << std::setw(14) << r.items
+                  << std::setw(16) << std::setprecision(0) << per_sec << std::setw(14) << r.allocations
+                  << std::setw(14) << r.bytes << "  " << r.unit << "\n";
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef BENCH_PIPELINE_H
+#define BENCH_PIPELINE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// shared by the benchmark tools: runs lex -> parse -> sema -> codegen over one source and times each phase
+struct PhaseResult
+{
+    const char* name;
+    const char* unit;
+    std::size_t items = 0;
+    double seconds = 0.0;
+    // only non-zero while allocation counting is on (see memstats.h)
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+};
+
+enum Phase
+{
+    PHASE_LEX, PHASE_PARSE, PHASE_SEMA, PHASE_CODEGEN, PHASE_COUNT
+};
+
+std::vector<PhaseResult> make_phase_results();
+
+// adds the work done and time taken by each phase to results; false if the source doesn't compile
+bool run_pipeline(const std::string& name, const std::string& source, std::vector<PhaseResult>& results);
+
+void print_phase_results(const std::vector<PhaseResult>& results);
+
+#endif // BENCH_PIPELINE_H
@@ -0,0 +1,133 @@
+// compiles generated programs at 1x/10x/100x size and fails if any phase grows faster than linearly in the input size
+// usage: minic-scaling [--scale functions|locals|depth|expression-size] [--max-exponent E] [--repeat N]
+//                      [--functions N] [--locals N] [--depth N] [--expression-size N] [--seed N]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "generator.h"
+#include "pipeline.h"
+
+namespace
+{
+    // timings below this are mostly noise, so they don't take part in the growth check
+    constexpr double min_measurable_seconds = 0.005;
+
+    std::size_t* scaled_dimension(GeneratorOptions& options, const std::string& name)
+    {
+        if (name == "functions") return &options.functions;
+        if (name == "locals") return &options.locals;
+        if (name == "depth") return &options.depth;
+        if (name == "expression-size") return &options.expression_size;
+        return nullptr;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    GeneratorOptions base;
+    std::string scale = "functions";
+    double max_exponent = 1.25;
+    std::size_t repeat = 3;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string arg = argv[i];
+        const char* value = argv[i + 1];
+        if (arg == "--scale") scale = value;
+        else if (arg == "--max-exponent") max_exponent = std::strtod(value, nullptr);
+        else if (arg == "--repeat") repeat = std::max<std::size_t>(1, std::strtoull(value, nullptr, 10));
+        else if (auto dim = arg.starts_with("--") ? scaled_dimension(base, arg.substr(2)) : nullptr) *dim = std::strtoull(value, nullptr, 10);
+        else if (arg == "--seed") base.seed = std::strtoull(value, nullptr, 10);
+        else
+        {
+            std::cerr << "minic-scaling: unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+
+    if (argc % 2 == 0 || !scaled_dimension(base, scale))
+    {
+        std::cerr << "Usage: minic-scaling [--scale functions|locals|depth|expression-size] [--max-exponent E] [--repeat N] [generator options]\n";
+        return 1;
+    }
+
+    const std::size_t factors[] = {1, 10, 100};
+    std::vector<std::vector<PhaseResult>> runs;
+    std::vector<std::size_t> sizes;
+
+    std::cout << "scaling " << scale << " (base " << *scaled_dimension(base, scale) << ")\n\n";
+    std::cout << std::left << std::setw(8) << "factor" << std::right << std::setw(14) << "bytes";
+    for (const auto& r : make_phase_results())
+    {
+        std::cout << std::setw(22) << r.name;
+    }
+    std::cout << "\n";
+
+    for (const auto factor : factors)
+    {
+        auto options = base;
+        *scaled_dimension(options, scale) *= factor;
+
+        std::ostringstream program;
+        generate_program(options, program);
+        const auto source = program.str();
+
+        // best of n, per phase
+        auto best = make_phase_results();
+        for (std::size_t i = 0; i < repeat; ++i)
+        {
+            auto results = make_phase_results();
+            if (!run_pipeline("generated program", source, results)) return 1;
+
+            for (std::size_t p = 0; p < results.size(); ++p)
+            {
+                if (i == 0 || results[p].seconds < best[p].seconds) best[p] = results[p];
+            }
+        }
+
+        std::cout << std::left << std::setw(8) << (std::to_string(factor) + "x") << std::right << std::setw(14) << source.size();
+        for (const auto& r : best)
+        {
+            std::cout << std::setw(19) << std::fixed << std::setprecision(2) << r.seconds * 1000.0 << " ms";
+        }
+        std::cout << "\n";
+        runs.push_back(std::move(best));
+        sizes.push_back(source.size());
+    }
+
+    // growth exponent relative to the input size, between neighbouring runs: 1 is linear, 2 is quadratic
+    bool super_linear = false;
+    std::cout << "\n";
+    for (std::size_t p = 0; p < PHASE_COUNT; ++p)
+    {
+        std::cout << std::left << std::setw(22) << runs[0][p].name << std::right;
+        for (std::size_t i = 1; i < runs.size(); ++i)
+        {
+            const double before = runs[i - 1][p].seconds, after = runs[i][p].seconds;
+            std::cout << "  " << factors[i - 1] << "x->" << factors[i] << "x: ";
+            if (before < min_measurable_seconds)
+            {
+                std::cout << std::setw(6) << "n/a";
+                continue;
+            }
+
+            const double exponent = std::log(after / before) / std::log(static_cast<double>(sizes[i]) / sizes[i - 1]);
+            std::cout << std::setw(6) << std::setprecision(2) << exponent;
+            if (exponent > max_exponent)
+            {
+                std::cout << " (super-linear!)";
+                super_linear = true;
+            }
+        }
+        std::cout << "\n";
+    }
+
+    return super_linear ? 1 : 0;
+}
@@ -0,0 +1,14 @@
+# writes OUTPUT, a header defining MINIC_FRONTEND_HASH: a hash over the contents of SOURCES (a ;-list), so it
+# changes with every edit to the compiler, committed or not. run at build time by the minic target
+#   cmake -DSOURCES=... -DOUTPUT=... -P frontend_hash.cmake
+
+list(SORT SOURCES)
+set(hashes "")
+foreach(source IN LISTS SOURCES)
+    file(SHA256 ${source} hash)
+    string(APPEND hashes "${hash}\n")
+endforeach()
+string(SHA256 combined "${hashes}")
+string(SUBSTRING "${combined}" 0 16 combined)
+
+file(WRITE ${OUTPUT} "// generated by cmake/frontend_hash.cmake, part of the AST cache's key\n#define MINIC_FRONTEND_HASH \"${combined}\"\n")
@@ -0,0 +1,384 @@
+// performance fuzzer for the Lexer -> Parser -> SemanticAnalyzer pipeline: hunts for inputs whose work per
+// input byte grows faster than linearly (e.g. the linear scans over SemanticAnalyzer::declared_variables)
+//
+// standalone:  minic-perf-fuzz [--runs N] [--max-len BYTES] [--factor X] [--seed N] [--out DIR] [seed-files...]
+// libFuzzer:   built as minic-perf-fuzz-libfuzzer with clang and -DMINIC_LIBFUZZER=ON; inputs over the limit
+//              abort, so libFuzzer keeps them as crash artifacts
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "error.h"
+#include "lexer.h"
+#include "parser.h"
+#include "semanalyzer.h"
+
+namespace
+{
+    // deterministic work units: how much each phase did, independent of the machine it ran on
+    struct Work
+    {
+        std::uint64_t tokens = 0;
+        std::uint64_t nodes = 0;
+        std::uint64_t sema = 0;
+
+        std::uint64_t total() const { return tokens + nodes + sema; }
+    };
+
+    Work measure(std::string_view input)
+    {
+        Work work;
+        // errors are expected on most mutated inputs, keep them quiet and out of get_err()
+        ErrorCapture errors;
+
+        Interner names;
+        Lexer lexer(input, names);
+        const auto& tokens = lexer.lex();
+        work.tokens = tokens.size();
+        if (errors.failed()) return work;
+
+        Parser parser(tokens);
+        auto program = parser.get_program();
+        NodeCounter counter;
+        counter.count(program);
+        work.nodes = counter.total();
+        if (errors.failed()) return work;
+
+        SemanticAnalyzer analyzer(program.nodes, names, lexer.get_lines());
+        for (auto& d : program)
+        {
+            auto [ok, rich] = analyzer.perform_analysis(d);
+            if (!ok) break;
+            d = std::move(rich);
+        }
+
+        const auto& c = analyzer.get_counters();
+        work.sema = c.variable_lookups + c.variable_probes + c.variables_declared + c.function_lookups
+            + c.scope_pushes + c.scope_exit_scans;
+        return work;
+    }
+
+    double work_per_byte(std::string_view input)
+    {
+        return static_cast<double>(measure(input).total()) / static_cast<double>(std::max<std::size_t>(input.size(), 1));
+    }
+
+    // default limit for libFuzzer runs, where there are no seeds to calibrate against: a few times what the
+    // linear programs in bench/corpus cost per byte
+    constexpr double default_work_per_byte_limit = 2.0;
+}
+
+#ifdef MINIC_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    static const double limit = []
+    {
+        const char* env = std::getenv("MINIC_PERF_FUZZ_LIMIT");
+        return env ? std::strtod(env, nullptr) : default_work_per_byte_limit;
+    }();
+
+    const std::string_view input(reinterpret_cast<const char*>(data), size);
+    const double per_byte = work_per_byte(input);
+    if (size >= 64 && per_byte > limit)
+    {
+        std::cerr << "minic-perf-fuzz: " << per_byte << " work units per byte (limit " << limit << ")\n";
+        std::abort();
+    }
+    return 0;
+}
+
+#else
+
+namespace
+{
+    std::vector<std::string> split_lines(const std::string& s)
+    {
+        std::vector<std::string> lines;
+        std::istringstream in(s);
+        for (std::string line; std::getline(in, line);)
+        {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    std::string join_lines(const std::vector<std::string>& lines)
+    {
+        std::string out;
+        for (const auto& line : lines)
+        {
+            out += line;
+            out += '\n';
+        }
+        return out;
+    }
+
+    // structure-aware mutations, so most children still get past the parser and into the analyzer
+    class Mutator
+    {
+    public:
+        explicit Mutator(std::uint64_t seed) : rng(seed) {}
+
+        std::string mutate(const std::string& parent, const std::vector<std::string>& corpus)
+        {
+            auto lines = split_lines(parent);
+            if (lines.empty()) lines.push_back("");
+
+            const auto rounds = 1 + pick(8);
+            for (std::size_t i = 0; i < rounds; ++i)
+            {
+                switch (pick(7))
+                {
+                case 0: duplicate_line(lines); break;
+                case 1: insert_declaration(lines); break;
+                case 2: insert_assignment(lines); break;
+                case 3: wrap_in_block(lines); break;
+                case 4: splice(lines, corpus); break;
+                case 5: if (lines.size() > 1) lines.erase(lines.begin() + pick(lines.size())); break;
+                default: flip_byte(lines); break;
+                }
+            }
+
+            return join_lines(lines);
+        }
+
+    private:
+        void duplicate_line(std::vector<std::string>& lines)
+        {
+            const auto at = pick(lines.size());
+            auto copy = lines[at];
+            // rename a declaration, or the copy is just a duplicate-variable error
+            if (const auto eq = copy.find(" ="); copy.find("int ") != std::string::npos && eq != std::string::npos)
+            {
+                copy.insert(eq, "d" + std::to_string(fresh++));
+            }
+            lines.insert(lines.begin() + at + 1, copy);
+        }
+
+        void insert_declaration(std::vector<std::string>& lines)
+        {
+            const auto names = identifiers(lines);
+            lines.insert(lines.begin() + pick(lines.size() + 1),
+                         "int z" + std::to_string(fresh++) + " = " + any(names) + " + " + any(names) + ";");
+        }
+
+        void insert_assignment(std::vector<std::string>& lines)
+        {
+            const auto names = identifiers(lines);
+            lines.insert(lines.begin() + pick(lines.size() + 1), any(names) + " = " + any(names) + " - 1;");
+        }
+
+        void wrap_in_block(std::vector<std::string>& lines)
+        {
+            const auto first = pick(lines.size());
+            const auto last = first + pick(lines.size() - first);
+            lines.insert(lines.begin() + last + 1, "}");
+            lines.insert(lines.begin() + first, pick(2) ? "{" : "while (1 < 2) {");
+        }
+
+        void splice(std::vector<std::string>& lines, const std::vector<std::string>& corpus)
+        {
+            const auto donor = split_lines(corpus[pick(corpus.size())]);
+            if (donor.empty()) return;
+            lines.insert(lines.begin() + pick(lines.size() + 1), donor[pick(donor.size())]);
+        }
+
+        void flip_byte(std::vector<std::string>& lines)
+        {
+            static constexpr std::string_view alphabet = "(){};=+-<>!&|,\"0123456789abvz \n";
+            auto& line = lines[pick(lines.size())];
+            const char c = alphabet[pick(alphabet.size())];
+            if (line.empty() || pick(2))
+            {
+                line.insert(line.begin() + pick(line.size() + 1), c);
+            }
+            else
+            {
+                line[pick(line.size())] = c;
+            }
+        }
+
+        // identifier-looking words already in the input, so new statements refer to things that exist
+        static std::vector<std::string> identifiers(const std::vector<std::string>& lines)
+        {
+            std::vector<std::string> names;
+            for (const auto& line : lines)
+            {
+                for (std::size_t i = 0; i < line.size();)
+                {
+                    if (!std::isalpha(static_cast<unsigned char>(line[i])))
+                    {
+                        ++i;
+                        continue;
+                    }
+
+                    const auto start = i;
+                    while (i < line.size() && std::isalnum(static_cast<unsigned char>(line[i]))) ++i;
+                    auto word = line.substr(start, i - start);
+                    if (word != "int" && word != "void" && word != "return" && word != "while" && word != "if"
+                        && word != "else" && word != "printf")
+                    {
+                        names.push_back(std::move(word));
+                    }
+                }
+            }
+            return names;
+        }
+
+        std::string any(const std::vector<std::string>& names)
+        {
+            return names.empty() ? "1" : names[pick(names.size())];
+        }
+
+        std::size_t pick(std::size_t bound)
+        {
+            return bound == 0 ? 0 : static_cast<std::size_t>(rng() % bound);
+        }
+
+    private:
+        std::mt19937_64 rng;
+        std::size_t fresh = 0;
+    };
+
+    std::size_t size_bucket(std::size_t size)
+    {
+        std::size_t bucket = 0;
+        while (size > 1)
+        {
+            size >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    std::string read_file(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return (std::ostringstream() << in.rdbuf()).str();
+    }
+}
+
+static const char* usage =
+    "Usage: minic-perf-fuzz [--runs N] [--max-len BYTES] [--factor X] [--seed N] [--out DIR] [seed-files...]\n";
+
+int main(int argc, char* argv[])
+{
+    std::size_t runs = 20000;
+    std::size_t max_len = 16 * 1024;
+    double factor = 4.0;
+    std::uint64_t seed = 1;
+    std::string out_dir = "perf-fuzz-out";
+    std::vector<std::string> seed_paths;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--runs" && has_value) runs = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--max-len" && has_value) max_len = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--factor" && has_value) factor = std::strtod(argv[++i], nullptr);
+        else if (arg == "--seed" && has_value) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--out" && has_value) out_dir = argv[++i];
+        else if (arg.starts_with("--"))
+        {
+            std::cerr << usage;
+            return 1;
+        }
+        else seed_paths.push_back(arg);
+    }
+
+    if (seed_paths.empty())
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(MINIC_BENCH_CORPUS))
+        {
+            if (entry.path().extension() == ".c") seed_paths.push_back(entry.path().string());
+        }
+        std::sort(seed_paths.begin(), seed_paths.end());
+    }
+
+    std::vector<std::string> corpus;
+    double seed_per_byte = 0.0;
+    for (const auto& path : seed_paths)
+    {
+        corpus.push_back(read_file(path));
+        seed_per_byte = std::max(seed_per_byte, work_per_byte(corpus.back()));
+    }
+
+    if (corpus.empty() || seed_per_byte == 0.0)
+    {
+        std::cerr << usage;
+        return 1;
+    }
+
+    // the seeds are ordinary, linear programs: anything costing a multiple of their worst per-byte work is suspect
+    const double limit = factor * seed_per_byte;
+    std::cout << "seeds: " << corpus.size() << ", worst seed " << seed_per_byte << " work/byte, saving inputs over "
+              << limit << " work/byte to " << out_dir << "/\n";
+
+    // best work/byte found so far per power-of-two input size; a new best means the input goes into the corpus
+    std::map<std::size_t, std::pair<double, std::uint64_t>> best;
+    std::filesystem::create_directories(out_dir);
+    Mutator mutator(seed);
+    std::mt19937_64 rng(seed);
+    std::size_t saved = 0;
+
+    for (std::size_t run = 0; run < runs; ++run)
+    {
+        // favour recent finds, they're the ones still climbing
+        const auto parent = rng() % 2 ? corpus.size() - 1 - rng() % std::min<std::size_t>(corpus.size(), 16) : rng() % corpus.size();
+        auto child = mutator.mutate(corpus[parent], corpus);
+        if (child.size() > max_len || child.empty()) continue;
+
+        const auto work = measure(child).total();
+        const double per_byte = static_cast<double>(work) / static_cast<double>(child.size());
+        auto& [best_per_byte, best_work] = best[size_bucket(child.size())];
+        if (per_byte <= best_per_byte) continue;
+
+        best_per_byte = per_byte;
+        best_work = work;
+        corpus.push_back(child);
+
+        if (per_byte > limit)
+        {
+            const auto name = out_dir + "/slow-" + std::to_string(child.size()) + "-"
+                + std::to_string(std::hash<std::string>{}(child)) + ".c";
+            std::ofstream(name, std::ios::binary) << child;
+            std::cout << "run " << run << ": " << child.size() << " bytes, " << per_byte << " work/byte -> " << name << "\n";
+            ++saved;
+        }
+    }
+
+    // the growth exponent of the worst work found per size: ~1 for linear code, ~2 for quadratic blowups
+    std::cout << "\nsize bucket      best work/byte   growth exponent\n";
+    const std::pair<const std::size_t, std::pair<double, std::uint64_t>>* previous = nullptr;
+    for (const auto& entry : best)
+    {
+        std::cout << "  ~" << (std::size_t{1} << entry.first) << " bytes\t" << entry.second.first;
+        if (previous && previous->second.second > 0)
+        {
+            const double size_ratio = std::pow(2.0, static_cast<double>(entry.first - previous->first));
+            std::cout << "\t\t" << std::log(static_cast<double>(entry.second.second) / previous->second.second) / std::log(size_ratio);
+        }
+        std::cout << "\n";
+        previous = &entry;
+    }
+
+    std::cout << "\n" << saved << " super-linear inputs saved\n";
+    return 0;
+}
+
+#endif
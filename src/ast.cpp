@@ -0,0 +1,103 @@
+#include "ast.h"
+
+#include <utility>
+
+namespace
+{
+    using Shift = AST::Nodes::Shift;
+
+    // renumbers the references a node holds, for nodes moved from one Nodes to the end of another
+    void shift_refs(AST::Unary& node, const Shift& by) { node.operand = by.shifted(node.operand); }
+    void shift_refs(AST::Literal&, const Shift&) {}
+    void shift_refs(AST::Binary& node, const Shift& by)
+    {
+        node.left = by.shifted(node.left);
+        node.right = by.shifted(node.right);
+    }
+    void shift_refs(AST::Assignment& node, const Shift& by)
+    {
+        node.lhs = by.shifted(node.lhs);
+        node.rhs = by.shifted(node.rhs);
+    }
+    void shift_refs(AST::Call& node, const Shift& by) { node.args = by.shifted(node.args); }
+    void shift_refs(AST::Variable&, const Shift&) {}
+    void shift_refs(AST::StructAccess& node, const Shift& by) { node.lhs = by.shifted(node.lhs); }
+    void shift_refs(AST::ArrayAccess& node, const Shift& by)
+    {
+        node.lhs = by.shifted(node.lhs);
+        node.index = by.shifted(node.index);
+    }
+
+    void shift_refs(AST::BlockStatement& node, const Shift& by) { node.statements = by.shifted(node.statements); }
+    void shift_refs(AST::PrintStatement& node, const Shift& by) { node.value = by.shifted(node.value); }
+    void shift_refs(AST::VariableDecl& node, const Shift& by) { node.value = by.shifted(node.value); }
+    void shift_refs(AST::ReturnStatement& node, const Shift& by)
+    {
+        if (node.value.has_value()) node.value = by.shifted(node.value.value());
+    }
+    void shift_refs(AST::ExpressionStatement& node, const Shift& by) { node.expr = by.shifted(node.expr); }
+    void shift_refs(AST::IfElseStatement& node, const Shift& by)
+    {
+        node.condition = by.shifted(node.condition);
+        node.if_body = by.shifted(node.if_body);
+        node.else_body = by.shifted(node.else_body);
+    }
+    void shift_refs(AST::WhileStatement& node, const Shift& by)
+    {
+        node.condition = by.shifted(node.condition);
+        node.body = by.shifted(node.body);
+    }
+    void shift_refs(AST::FunctionDeclaration& node, const Shift& by)
+    {
+        node.params = by.shifted(node.params);
+        node.body = by.shifted(node.body);
+    }
+
+    // the list arrays
+    void shift_refs(AST::ExprVariant& item, const Shift& by) { item = by.shifted(item); }
+    void shift_refs(AST::StatementVariant& item, const Shift& by) { item = by.shifted(item); }
+    void shift_refs(AST::FunctionDeclaration::FunctionArg&, const Shift&) {}
+
+    template <typename T>
+    void append_kind(std::vector<T>& to, std::vector<T>& from, const Shift& by)
+    {
+        to.reserve(to.size() + from.size());
+        for (auto& node : from)
+        {
+            shift_refs(node, by);
+            to.push_back(std::move(node));
+        }
+        std::vector<T>().swap(from);
+    }
+}
+
+AST::Nodes::Shift AST::Nodes::append(Nodes&& other)
+{
+    Shift shift;
+    [&]<std::size_t... Kind>(std::index_sequence<Kind...>)
+    {
+        ((shift.by[Kind] = static_cast<std::uint32_t>(std::get<Kind>(pools).size())), ...);
+        assert(((std::get<Kind>(pools).size() + std::get<Kind>(other.pools).size() < UINT32_MAX) && ...) && "too many nodes for 32-bit indices");
+
+        if (((shift.by[Kind] == 0) && ...))
+        {
+            // nothing to make room for, the arrays can be taken as they are
+            pools = std::move(other.pools);
+            other.pools = {};
+            return;
+        }
+        (append_kind(std::get<Kind>(pools), std::get<Kind>(other.pools), shift), ...);
+    }(std::make_index_sequence<kinds>{});
+    return shift;
+}
+
+void AST::TranslationUnit::append(TranslationUnit&& other)
+{
+    const auto shift = nodes.append(std::move(other.nodes));
+    declarations.reserve(declarations.size() + other.declarations.size());
+    for (const auto& declaration : other.declarations)
+    {
+        declarations.push_back(shift.shifted(declaration));
+    }
+    other.declarations.clear();
+}
@@ -1,23 +1,39 @@
 #ifndef AST_H
 #define AST_H
 
-#include <variant>
-#include <memory>
+#include <cassert>
+#include <cstdint>
 #include <optional>
-#include <vector>
+#include <span>
 #include <string>
+#include <tuple>
+#include <variant>
+#include <vector>
 #include "lexer.h"
 
 namespace AST
 {
-    enum class LiteralType
+    // what sema works an expression out to be, and what declarations ask for. a byte, not a spelling: programs
+    // can only name a few types (no typedefs, structs aren't analyzed yet), anything else is UNKNOWN
+    enum class Type : std::uint8_t
     {
-        INT, CHAR, FLOAT, DOUBLE, CSTRING, UNKNOWN
+        UNKNOWN, INT, CHAR, FLOAT, DOUBLE, CSTRING, VOID
     };
 
+    // the type a type keyword names, UNKNOWN for anything else (struct names included)
+    constexpr Type type_from_token(const TokenType token)
+    {
+        switch (token)
+        {
+        case TokenType::INT: return Type::INT;
+        case TokenType::CHAR: return Type::CHAR;
+        case TokenType::VOID: return Type::VOID;
+        default: return Type::UNKNOWN;
+        }
+    }
+
     using LiteralVariant = std::variant<int, std::string, char, float, double>;
 
-    struct Expression;
     struct Literal;
     struct Binary;
     struct Unary;
@@ -27,24 +43,57 @@ namespace AST
     struct StructAccess;
     struct ArrayAccess;
 
+    // nodes live in their translation unit's Nodes, one array per kind, and point at each other by 32-bit
+    // index into those. children are made before their parents, so a function's nodes end up next to each
+    // other and a walk over it stays within a few arrays instead of hopping around the heap
+    template <typename T>
+    struct Ref
+    {
+        using element_type = T;
+        static constexpr std::uint32_t NONE = UINT32_MAX;
+
+        std::uint32_t index = NONE;
+
+        explicit operator bool() const { return index != NONE; }
+    };
+
+    // a run of children (statements of a block, arguments of a call, ...), stored back to back in a list pool
+    template <typename T>
+    struct List
+    {
+        std::uint32_t first = 0;
+        std::uint32_t count = 0;
+
+        std::size_t size() const { return count; }
+    };
+
     struct Expression
     {
-        std::size_t line;
+        SourceLocation location;
 
-        explicit Expression(const size_t line) : line(line)
+        explicit Expression(const SourceLocation location) : location(location)
         {
         }
 
-        virtual ~Expression() = default;
-
-        std::string result_type = "__13190381minic_unknown"; // initialized in semantic analysis
+        Type result_type = Type::UNKNOWN; // initialized in semantic analysis
     };
 
+    using ExprVariant = std::variant<
+        Ref<Unary>,
+        Ref<Literal>,
+        Ref<Binary>,
+        Ref<Assignment>,
+        Ref<Call>,
+        Ref<Variable>,
+        Ref<StructAccess>,
+        Ref<ArrayAccess>
+    >;
+
     struct Variable : Expression
     {
-        Token name;
+        Symbol name;
 
-        Variable(const size_t line, Token name) : Expression(line), name(std::move(name))
+        Variable(const SourceLocation location, const Symbol name) : Expression(location), name(name)
         {
         }
     };
@@ -53,50 +102,19 @@ namespace AST
     {
         LiteralVariant value;
 
-        Literal(const size_t line, LiteralVariant value) : Expression(line), value(std::move(value))
-        {
-        }
-
-        Literal(const Literal &other)
-            : Expression(other.line), value(other.value)
+        Literal(const SourceLocation location, LiteralVariant value) : Expression(location), value(std::move(value))
         {
-            result_type = other.result_type;
-        }
-
-        Literal& operator=(const Literal& other)
-        {
-            if (this != &other)
-            {
-                line = other.line;
-                value = other.value;
-                result_type = other.result_type;
-            }
-            return *this;
         }
     };
 
-    template <typename T>
-    using _up = std::unique_ptr<T>;
-
-    using ExprVariant = std::variant<
-        _up<Unary>,
-        Literal,
-        _up<Binary>,
-        _up<Assignment>,
-        _up<Call>,
-        Variable,
-        _up<StructAccess>,
-        _up<ArrayAccess>
-    >;
-
     struct Binary : Expression
     {
         ExprVariant left;
         ExprVariant right;
         TokenType op;
 
-        Binary(const std::size_t line, ExprVariant left, TokenType op, ExprVariant right)
-            : Expression(line), left(std::move(left)), right(std::move(right)), op(op)
+        Binary(const SourceLocation location, ExprVariant left, TokenType op, ExprVariant right)
+            : Expression(location), left(left), right(right), op(op)
         {
         }
     };
@@ -106,8 +124,8 @@ namespace AST
         ExprVariant operand;
         TokenType op;
 
-        Unary(const std::size_t line, const TokenType op, ExprVariant operand)
-            : Expression(line), operand(std::move(operand)), op(op)
+        Unary(const SourceLocation location, const TokenType op, ExprVariant operand)
+            : Expression(location), operand(operand), op(op)
         {
         }
     };
@@ -118,19 +136,19 @@ namespace AST
         ExprVariant rhs;
         TokenType op;
 
-        Assignment(const std::size_t line, ExprVariant lhs, const TokenType op, ExprVariant rhs)
-            : Expression(line), lhs(std::move(lhs)), rhs(std::move(rhs)), op(op)
+        Assignment(const SourceLocation location, ExprVariant lhs, const TokenType op, ExprVariant rhs)
+            : Expression(location), lhs(lhs), rhs(rhs), op(op)
         {
         }
     };
 
     struct Call : Expression
     {
-        Token func_name;
-        std::vector<ExprVariant> args;
+        Symbol func_name;
+        List<ExprVariant> args;
 
-        Call(const std::size_t line, Token func_name, std::vector<ExprVariant> args)
-            : Expression(line), func_name(std::move(func_name)), args(std::move(args))
+        Call(const SourceLocation location, const Symbol func_name, List<ExprVariant> args)
+            : Expression(location), func_name(func_name), args(args)
         {
         }
     };
@@ -140,8 +158,8 @@ namespace AST
         ExprVariant lhs;
         std::string member_name;
 
-        StructAccess(const std::size_t line, ExprVariant lhs, std::string member_name)
-            : Expression(line), lhs(std::move(lhs)), member_name(std::move(member_name))
+        StructAccess(const SourceLocation location, ExprVariant lhs, std::string member_name)
+            : Expression(location), lhs(lhs), member_name(std::move(member_name))
         {
         }
     };
@@ -151,8 +169,8 @@ namespace AST
         ExprVariant lhs;
         ExprVariant index;
 
-        ArrayAccess(size_t line, ExprVariant lhs, ExprVariant index) :
-            Expression(line), lhs(std::move(lhs)), index(std::move(index))
+        ArrayAccess(const SourceLocation location, ExprVariant lhs, ExprVariant index) :
+            Expression(location), lhs(lhs), index(index)
         {
         }
     };
@@ -160,74 +178,55 @@ namespace AST
     struct ExprVisitor
     {
         virtual ~ExprVisitor() = default;
-        virtual void operator()(_up<Unary>&) = 0;
-        virtual void operator()(const Literal&) = 0;
-        virtual void operator()(_up<Binary>&) = 0;
-        virtual void operator()(_up<Assignment>&) = 0;
-        virtual void operator()(_up<Call>&) = 0;
-        virtual void operator()(const Variable&) = 0;
-        virtual void operator()(_up<StructAccess>&) = 0;
-        virtual void operator()(_up<ArrayAccess>&) = 0;
+        virtual void operator()(Ref<Unary>) = 0;
+        virtual void operator()(Ref<Literal>) = 0;
+        virtual void operator()(Ref<Binary>) = 0;
+        virtual void operator()(Ref<Assignment>) = 0;
+        virtual void operator()(Ref<Call>) = 0;
+        virtual void operator()(Ref<Variable>) = 0;
+        virtual void operator()(Ref<StructAccess>) = 0;
+        virtual void operator()(Ref<ArrayAccess>) = 0;
     };
 
-    inline std::string get_literal_type(const AST::Literal& lit)
+    inline Type get_literal_type(const AST::Literal& lit)
     {
         auto get_type_enum = [&]<typename T0>(T0&& x)
         {
             using U = std::decay_t<T0>;
             if constexpr (std::is_same_v<U, char>)
             {
-                return "char";
+                return Type::CHAR;
             }
             else if constexpr (std::is_same_v<U, int>)
             {
-                return "int";
+                return Type::INT;
             }
             else if constexpr (std::is_same_v<U, float>)
             {
-                return "float";
+                return Type::FLOAT;
             }
             else if constexpr (std::is_same_v<U, double>)
             {
-                return "double";
+                return Type::DOUBLE;
             }
             else if constexpr (std::is_same_v<U, std::string>)
             {
-                return "const char*";
+                return Type::CSTRING;
             }
 
-            return "__19192838mini_c_unknown"; // im slick with it
+            return Type::UNKNOWN;
         };
 
         return std::visit(get_type_enum, lit.value);
     }
 
-    // using stdlib is such a pain 😭
-    inline std::string get_type(const ExprVariant& e)
-    {
-        return std::visit([&]<typename T0>(T0& x)
-        {
-            using T = std::decay_t<T0>;
-            if constexpr (std::is_same_v<T, Literal> || std::is_same_v<T, Variable>)
-            {
-                return x.result_type;
-            }
-            else
-            {
-                return x->result_type;
-            }
-        }, e);
-    }
-
     struct Statement
     {
-        std::size_t line;
+        SourceLocation location;
 
-        explicit Statement(const size_t line) : line(line)
+        explicit Statement(const SourceLocation location) : location(location)
         {
         }
-
-        virtual ~Statement() = default;
     };
 
     struct PrintStatement;
@@ -239,30 +238,29 @@ namespace AST
     struct BlockStatement;
 
     using StatementVariant = std::variant<
-        _up<BlockStatement>,
-        _up<PrintStatement>,
-        _up<VariableDecl>,
-        _up<ReturnStatement>,
-        _up<ExpressionStatement>,
-        _up<IfElseStatement>,
-        _up<WhileStatement>
+        Ref<BlockStatement>,
+        Ref<PrintStatement>,
+        Ref<VariableDecl>,
+        Ref<ReturnStatement>,
+        Ref<ExpressionStatement>,
+        Ref<IfElseStatement>,
+        Ref<WhileStatement>
     >;
 
     struct ReturnStatement : Statement 
     {
         std::optional<ExprVariant> value; // can be empty for void functions
 
-        explicit ReturnStatement(const size_t line, std::optional<ExprVariant> value) : Statement(line), value(std::move(value))
+        explicit ReturnStatement(const SourceLocation location, std::optional<ExprVariant> value) : Statement(location), value(value)
         {
         }
     };
 
     struct BlockStatement : Statement
     {
-        std::vector<StatementVariant> statements;
+        List<StatementVariant> statements;
 
-        // statements are MOVED
-        explicit BlockStatement(const std::size_t line, std::vector<StatementVariant>& sts) : Statement(line), statements(std::move(sts))
+        explicit BlockStatement(const SourceLocation location, List<StatementVariant> statements) : Statement(location), statements(statements)
         {
         }
     };
@@ -271,24 +269,24 @@ namespace AST
     {
         AST::ExprVariant value;
 
-        explicit PrintStatement(const std::size_t line, AST::ExprVariant value)
-            : Statement(line), value(std::move(value))
+        explicit PrintStatement(const SourceLocation location, AST::ExprVariant value)
+            : Statement(location), value(value)
         {
         }
     };
 
     struct VariableDecl : Statement
     {
-        std::string name;
-        std::string type;
+        Symbol name;
+        Type type;
         std::size_t scope_depth = static_cast<std::size_t>(-1);
         ExprVariant value;
 
-        VariableDecl(const size_t line, const std::string& name, const std::string& type, ExprVariant& value)
-             : Statement(line),
+        VariableDecl(const SourceLocation location, const Symbol name, const Type type, ExprVariant value)
+             : Statement(location),
                name(name),
                type(type),
-               value(std::move(value))
+               value(value)
         {
         }
 
@@ -298,9 +296,9 @@ namespace AST
     {
         ExprVariant expr;
 
-        ExpressionStatement(const std::size_t line, ExprVariant& value)
-            : Statement(line),
-              expr(std::move(value))
+        ExpressionStatement(const SourceLocation location, ExprVariant value)
+            : Statement(location),
+              expr(value)
         {
         }
     };
@@ -311,8 +309,8 @@ namespace AST
         StatementVariant if_body;
         StatementVariant else_body;
 
-        IfElseStatement(const std::size_t line, ExprVariant& condition, StatementVariant& if_body, StatementVariant& else_body) :
-            Statement(line), condition(std::move(condition)), if_body(std::move(if_body)), else_body(std::move(else_body))
+        IfElseStatement(const SourceLocation location, ExprVariant condition, StatementVariant if_body, StatementVariant else_body) :
+            Statement(location), condition(condition), if_body(if_body), else_body(else_body)
         {
         }
     };
@@ -322,8 +320,8 @@ namespace AST
         ExprVariant condition;
         StatementVariant body;
 
-        WhileStatement(const std::size_t line, ExprVariant& condition, StatementVariant& body) :
-            Statement(line), condition(std::move(condition)), body(std::move(body))
+        WhileStatement(const SourceLocation location, ExprVariant condition, StatementVariant body) :
+            Statement(location), condition(condition), body(body)
         {
         }
     };
@@ -331,58 +329,185 @@ namespace AST
 
     struct Declaration 
     {
-        std::size_t line;
+        SourceLocation location;
 
-        explicit Declaration(const size_t line) : line(line)
+        explicit Declaration(const SourceLocation location) : location(location)
         {
         }
-
-        virtual ~Declaration() = default;
     };
     
     struct FunctionDeclaration; 
 
     using DeclarationVariant = std::variant<
-        _up<FunctionDeclaration>
+        Ref<FunctionDeclaration>
     >;
 
     struct FunctionDeclaration : Declaration
     {
         struct FunctionArg
         {
-            std::string type = "", name = "";
+            Type type = Type::UNKNOWN;
+            Symbol name = Symbol::NONE;
 
-            FunctionArg(const std::string& type, const std::string& name) : type(type), name(name)
+            FunctionArg(const Type type, const Symbol name) : type(type), name(name)
             {
             }
         };
 
-        std::string name;
-        std::string return_type;
-        std::vector<FunctionArg> params; // (name, type)
-        std::unique_ptr<BlockStatement> body;
+        Symbol name;
+        Type return_type;
+        List<FunctionArg> params; // (name, type)
+        Ref<BlockStatement> body;
+
+        FunctionDeclaration(const SourceLocation location, const Symbol name, const Type return_type,
+            List<FunctionArg> params, Ref<BlockStatement> body)
+            : Declaration(location), name(name), return_type(return_type), params(params), body(body)
+        {
+        }
+    };
+
+    // the node arrays of a translation unit. references into them are only good until the next make(), the
+    // arrays grow while parsing; once parsed nothing is added and sema and codegen can hold on to them
+    class Nodes
+    {
+    public:
+        template <typename T, typename... Args>
+        Ref<T> make(Args&&... args)
+        {
+            auto& pool = get_pool<T>();
+            assert(pool.size() < Ref<T>::NONE && "too many nodes for 32-bit indices");
+            pool.emplace_back(std::forward<Args>(args)...);
+            return Ref<T>{static_cast<std::uint32_t>(pool.size() - 1)};
+        }
+
+        // items are MOVED
+        template <typename T>
+        List<T> make_list(std::vector<T>& items)
+        {
+            auto& pool = get_pool<T>();
+            const List<T> list{static_cast<std::uint32_t>(pool.size()), static_cast<std::uint32_t>(items.size())};
+            pool.insert(pool.end(), std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+            items.clear();
+            return list;
+        }
+
+        template <typename T>
+        T& operator[](Ref<T> ref) { return get_pool<T>()[ref.index]; }
+        template <typename T>
+        const T& operator[](Ref<T> ref) const { return get_pool<T>()[ref.index]; }
+
+        template <typename T>
+        std::span<T> operator[](List<T> list) { return {get_pool<T>().data() + list.first, list.count}; }
+        template <typename T>
+        std::span<const T> operator[](List<T> list) const { return {get_pool<T>().data() + list.first, list.count}; }
+
+        // how many nodes of a kind there are
+        template <typename T>
+        std::size_t count() const { return get_pool<T>().size(); }
+
+        // room for n more nodes of a kind, for filling the arrays from a known count
+        template <typename T>
+        void reserve(std::size_t n) { get_pool<T>().reserve(get_pool<T>().size() + n); }
+
+        // moves other's nodes to the end of ours, with the references between them renumbered to their new
+        // places; refs that pointed into other get the same shift from shifted()
+        class Shift;
+        Shift append(Nodes&& other);
+
+    private:
+        template <typename T>
+        std::vector<T>& get_pool() { return std::get<std::vector<T>>(pools); }
+        template <typename T>
+        const std::vector<T>& get_pool() const { return std::get<std::vector<T>>(pools); }
+
+        std::tuple<
+            std::vector<Unary>, std::vector<Literal>, std::vector<Binary>, std::vector<Assignment>,
+            std::vector<Call>, std::vector<Variable>, std::vector<StructAccess>, std::vector<ArrayAccess>,
+            std::vector<BlockStatement>, std::vector<PrintStatement>, std::vector<VariableDecl>,
+            std::vector<ReturnStatement>, std::vector<ExpressionStatement>, std::vector<IfElseStatement>,
+            std::vector<WhileStatement>, std::vector<FunctionDeclaration>,
+            // the lists
+            std::vector<ExprVariant>, std::vector<StatementVariant>, std::vector<FunctionDeclaration::FunctionArg>
+        > pools;
+
+        static constexpr std::size_t kinds = std::tuple_size_v<decltype(pools)>;
+
+        // where a kind's array sits in pools
+        template <typename T>
+        static constexpr std::size_t kind_index = []<typename... Ts>(std::type_identity<std::tuple<std::vector<Ts>...>>)
+        {
+            std::size_t i = 0;
+            ((std::is_same_v<T, Ts> ? false : (++i, true)) && ...);
+            return i;
+        }(std::type_identity<decltype(pools)>{});
+    };
+
+    // how far append() moved each kind of node
+    class Nodes::Shift
+    {
+    public:
+        template <typename T>
+        Ref<T> shifted(Ref<T> ref) const
+        {
+            return ref ? Ref<T>{ref.index + by[kind_index<T>]} : ref;
+        }
 
-        FunctionDeclaration(const size_t line, const std::string& name, const std::string& return_type,
-            const std::vector<FunctionArg>& params, _up<BlockStatement> body)
-            : Declaration(line), name(name), return_type(return_type), params(params), body(std::move(body))
+        template <typename T>
+        List<T> shifted(List<T> list) const
         {
+            return List<T>{list.first + by[kind_index<T>], list.count};
         }
+
+        template <typename... Ts>
+        std::variant<Ts...> shifted(const std::variant<Ts...>& ref) const
+        {
+            return std::visit([&](auto x) { return std::variant<Ts...>{shifted(x)}; }, ref);
+        }
+
+    private:
+        friend class Nodes;
+        std::uint32_t by[kinds] = {};
     };
 
-    inline std::string literal_type_to_str(const LiteralType literal)
+    // using stdlib is such a pain 😭
+    inline Type get_type(const Nodes& nodes, const ExprVariant& e)
+    {
+        return std::visit([&](auto x)
+        {
+            return nodes[x].result_type;
+        }, e);
+    }
+
+    inline std::string type_to_str(const Type type)
     {
-        switch (literal)
+        switch (type)
         {
-        case LiteralType::CHAR: return "char";
-        case LiteralType::INT: return "int";
-        case LiteralType::FLOAT: return "float";
-        case LiteralType::DOUBLE: return "double";
-        case LiteralType::CSTRING: return "const char*";
-        case LiteralType::UNKNOWN: return "unknown";
+        case Type::CHAR: return "char";
+        case Type::INT: return "int";
+        case Type::FLOAT: return "float";
+        case Type::DOUBLE: return "double";
+        case Type::CSTRING: return "const char*";
+        case Type::VOID: return "void";
+        case Type::UNKNOWN: return "unknown";
         }
 
         return "";
     }
+    // a parsed source file: its declarations and the nodes they're made of
+    struct TranslationUnit
+    {
+        Nodes nodes;
+        std::vector<DeclarationVariant> declarations;
+
+        // other's declarations go after ours, its nodes after our nodes
+        void append(TranslationUnit&& other);
+
+        auto begin() { return declarations.begin(); }
+        auto end() { return declarations.end(); }
+        auto begin() const { return declarations.begin(); }
+        auto end() const { return declarations.end(); }
+        std::size_t size() const { return declarations.size(); }
+    };
 } // namespace AST
 
 #endif // AST_H
@@ -0,0 +1,586 @@
+#include "ast_cache.h"
+
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+// generated by the build, see cmake/frontend_hash.cmake
+#if __has_include("frontend_hash.h")
+#include "frontend_hash.h"
+#endif
+
+#ifndef MINIC_VERSION
+#define MINIC_VERSION "unknown"
+#endif
+#ifndef MINIC_FRONTEND_HASH
+#define MINIC_FRONTEND_HASH "unknown"
+#endif
+
+namespace
+{
+    // bumped whenever the nodes, or what sema leaves in them, change; entries written before then just miss.
+    // builds from other sources already miss through MINIC_FRONTEND_HASH, this is for when that isn't in the
+    // key (a build outside cmake), so any change to what the parser or sema produce has to bump it too
+    constexpr std::uint32_t format_version = 2;
+
+    // entries are read back by the same build of the compiler on the same machine, so everything is stored in
+    // native byte order and the header only has to tell a stale or foreign entry apart
+    struct Header
+    {
+        char magic[8] = {'m', 'i', 'n', 'i', 'c', 'a', 's', 't'};
+        std::uint32_t format = format_version;
+        std::uint32_t byte_order = 0x01020304;
+        std::uint64_t key = 0;
+        std::uint64_t source_size = 0;
+        std::uint64_t payload_hash = 0; // of everything after the header
+    };
+
+    // appends fields to a byte string. strings (string literals, mostly) go through a table and are written as
+    // their index in it, so repeated ones are stored once
+    class Writer
+    {
+    public:
+        template <typename T>
+        using Field = const T;
+
+        template <typename T>
+        void operator()(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "needs its own overload");
+            out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void operator()(const std::string& value)
+        {
+            const auto [entry, inserted] = string_ids.try_emplace(value, static_cast<std::uint32_t>(strings.size()));
+            if (inserted)
+            {
+                strings.push_back(entry->getKey());
+            }
+            (*this)(entry->second);
+        }
+
+        template <typename... Ts>
+        void operator()(const std::variant<Ts...>& value)
+        {
+            (*this)(static_cast<std::uint8_t>(value.index()));
+            std::visit([&](const auto& x) { (*this)(x); }, value);
+        }
+
+        template <typename T>
+        void operator()(const std::optional<T>& value)
+        {
+            (*this)(static_cast<std::uint8_t>(value.has_value()));
+            if (value)
+            {
+                (*this)(*value);
+            }
+        }
+
+        // length, then the bytes
+        void bytes(llvm::StringRef value)
+        {
+            (*this)(static_cast<std::uint32_t>(value.size()));
+            out.append(value.data(), value.size());
+        }
+
+        std::string out;
+        std::vector<llvm::StringRef> strings;
+
+    private:
+        llvm::StringMap<std::uint32_t> string_ids;
+    };
+
+    // reads fields back in the order they were written. running past the end or an index out of range marks
+    // the whole read failed, the rest of it then reads zeros
+    class Reader
+    {
+    public:
+        template <typename T>
+        using Field = T;
+
+        explicit Reader(llvm::StringRef data) : at(data.begin()), end(data.end())
+        {
+        }
+
+        template <typename T>
+        void operator()(T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "needs its own overload");
+            if (const auto from = take(sizeof(T)))
+            {
+                std::memcpy(&value, from, sizeof(T));
+            }
+        }
+
+        void operator()(std::string& value)
+        {
+            std::uint32_t id = 0;
+            (*this)(id);
+            if (id < strings.size())
+            {
+                value = strings[id];
+            }
+            else
+            {
+                failed = true;
+            }
+        }
+
+        // identifiers have to have been read into the interner first
+        void operator()(Symbol& symbol)
+        {
+            std::uint32_t id = 0;
+            (*this)(id);
+            symbol = static_cast<Symbol>(id);
+            if (symbol != Symbol::NONE && id >= symbols)
+            {
+                failed = true;
+            }
+        }
+
+        template <typename... Ts>
+        void operator()(std::variant<Ts...>& value)
+        {
+            std::uint8_t index = 0;
+            (*this)(index);
+            if (index >= sizeof...(Ts))
+            {
+                failed = true;
+                return;
+            }
+            [&]<std::size_t... I>(std::index_sequence<I...>)
+            {
+                ((index == I ? (value.template emplace<I>(), (*this)(std::get<I>(value))) : void()), ...);
+            }(std::index_sequence_for<Ts...>{});
+        }
+
+        template <typename T>
+        void operator()(std::optional<T>& value)
+        {
+            std::uint8_t present = 0;
+            (*this)(present);
+            value.reset();
+            if (present)
+            {
+                (*this)(value.emplace());
+            }
+        }
+
+        llvm::StringRef bytes()
+        {
+            std::uint32_t size = 0;
+            (*this)(size);
+            const auto from = take(size);
+            return from ? llvm::StringRef(from, size) : llvm::StringRef();
+        }
+
+        std::size_t remaining() const { return end - at; }
+
+        std::vector<std::string> strings;
+        std::uint32_t symbols = 0;
+        bool failed = false;
+
+    private:
+        const char* take(std::size_t n)
+        {
+            if (failed || remaining() < n)
+            {
+                failed = true;
+                return nullptr;
+            }
+            const auto from = at;
+            at += n;
+            return from;
+        }
+
+        const char* at;
+        const char* end;
+    };
+
+    // every node's fields, for both directions: IO::Field is const for the writer
+    template <typename IO>
+    void expression_fields(IO& io, typename IO::template Field<AST::Expression>& node)
+    {
+        io(node.location);
+        io(node.result_type);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::Unary>& node)
+    {
+        expression_fields(io, node);
+        io(node.operand);
+        io(node.op);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::Literal>& node)
+    {
+        expression_fields(io, node);
+        io(node.value);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::Binary>& node)
+    {
+        expression_fields(io, node);
+        io(node.left);
+        io(node.right);
+        io(node.op);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::Assignment>& node)
+    {
+        expression_fields(io, node);
+        io(node.lhs);
+        io(node.rhs);
+        io(node.op);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::Call>& node)
+    {
+        expression_fields(io, node);
+        io(node.func_name);
+        io(node.args);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::Variable>& node)
+    {
+        expression_fields(io, node);
+        io(node.name);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::StructAccess>& node)
+    {
+        expression_fields(io, node);
+        io(node.lhs);
+        io(node.member_name);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::ArrayAccess>& node)
+    {
+        expression_fields(io, node);
+        io(node.lhs);
+        io(node.index);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::BlockStatement>& node)
+    {
+        io(node.location);
+        io(node.statements);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::PrintStatement>& node)
+    {
+        io(node.location);
+        io(node.value);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::VariableDecl>& node)
+    {
+        io(node.location);
+        io(node.name);
+        io(node.type);
+        io(node.scope_depth);
+        io(node.value);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::ReturnStatement>& node)
+    {
+        io(node.location);
+        io(node.value);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::ExpressionStatement>& node)
+    {
+        io(node.location);
+        io(node.expr);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::IfElseStatement>& node)
+    {
+        io(node.location);
+        io(node.condition);
+        io(node.if_body);
+        io(node.else_body);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::WhileStatement>& node)
+    {
+        io(node.location);
+        io(node.condition);
+        io(node.body);
+    }
+
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::FunctionDeclaration>& node)
+    {
+        io(node.location);
+        io(node.name);
+        io(node.return_type);
+        io(node.params);
+        io(node.body);
+    }
+
+    // the list arrays
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::ExprVariant>& item) { io(item); }
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::StatementVariant>& item) { io(item); }
+    template <typename IO>
+    void fields(IO& io, typename IO::template Field<AST::FunctionDeclaration::FunctionArg>& item)
+    {
+        io(item.type);
+        io(item.name);
+    }
+
+    // nodes to read the fields into
+    AST::Unary blank(std::type_identity<AST::Unary>) { return {{}, TokenType::END_OF_FILE, {}}; }
+    AST::Literal blank(std::type_identity<AST::Literal>) { return {{}, {}}; }
+    AST::Binary blank(std::type_identity<AST::Binary>) { return {{}, {}, TokenType::END_OF_FILE, {}}; }
+    AST::Assignment blank(std::type_identity<AST::Assignment>) { return {{}, {}, TokenType::END_OF_FILE, {}}; }
+    AST::Call blank(std::type_identity<AST::Call>) { return {{}, Symbol::NONE, {}}; }
+    AST::Variable blank(std::type_identity<AST::Variable>) { return {{}, Symbol::NONE}; }
+    AST::StructAccess blank(std::type_identity<AST::StructAccess>) { return {{}, {}, {}}; }
+    AST::ArrayAccess blank(std::type_identity<AST::ArrayAccess>) { return {{}, {}, {}}; }
+    AST::BlockStatement blank(std::type_identity<AST::BlockStatement>) { return AST::BlockStatement({}, {}); }
+    AST::PrintStatement blank(std::type_identity<AST::PrintStatement>) { return AST::PrintStatement({}, {}); }
+    AST::VariableDecl blank(std::type_identity<AST::VariableDecl>) { return {{}, Symbol::NONE, AST::Type::UNKNOWN, {}}; }
+    AST::ReturnStatement blank(std::type_identity<AST::ReturnStatement>) { return AST::ReturnStatement({}, {}); }
+    AST::ExpressionStatement blank(std::type_identity<AST::ExpressionStatement>) { return {{}, {}}; }
+    AST::IfElseStatement blank(std::type_identity<AST::IfElseStatement>) { return {{}, {}, {}, {}}; }
+    AST::WhileStatement blank(std::type_identity<AST::WhileStatement>) { return {{}, {}, {}}; }
+    AST::FunctionDeclaration blank(std::type_identity<AST::FunctionDeclaration>) { return {{}, Symbol::NONE, AST::Type::UNKNOWN, {}, {}}; }
+    AST::ExprVariant blank(std::type_identity<AST::ExprVariant>) { return {}; }
+    AST::StatementVariant blank(std::type_identity<AST::StatementVariant>) { return {}; }
+    AST::FunctionDeclaration::FunctionArg blank(std::type_identity<AST::FunctionDeclaration::FunctionArg>) { return {AST::Type::UNKNOWN, Symbol::NONE}; }
+
+    template <typename... Kinds>
+    struct KindList
+    {
+    };
+
+    // every array of a Nodes, in the order they're stored in an entry
+    using AllKinds = KindList<
+        AST::Unary, AST::Literal, AST::Binary, AST::Assignment, AST::Call, AST::Variable, AST::StructAccess,
+        AST::ArrayAccess, AST::BlockStatement, AST::PrintStatement, AST::VariableDecl, AST::ReturnStatement,
+        AST::ExpressionStatement, AST::IfElseStatement, AST::WhileStatement, AST::FunctionDeclaration,
+        AST::ExprVariant, AST::StatementVariant, AST::FunctionDeclaration::FunctionArg
+    >;
+
+    template <typename... Kinds>
+    void write_nodes(Writer& out, const AST::Nodes& nodes, KindList<Kinds...>)
+    {
+        ([&]
+        {
+            const auto count = static_cast<std::uint32_t>(nodes.count<Kinds>());
+            out(count);
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                fields(out, nodes[AST::Ref<Kinds>{i}]);
+            }
+        }(), ...);
+    }
+
+    template <typename... Kinds>
+    void read_nodes(Reader& in, AST::Nodes& nodes, KindList<Kinds...>)
+    {
+        ([&]
+        {
+            std::uint32_t count = 0;
+            in(count);
+            // every node takes at least a byte, a bigger count is a damaged entry and not worth reserving for
+            if (count > in.remaining())
+            {
+                in.failed = true;
+            }
+            if (in.failed)
+            {
+                return;
+            }
+
+            nodes.reserve<Kinds>(count);
+            for (std::uint32_t i = 0; i < count && !in.failed; ++i)
+            {
+                auto node = blank(std::type_identity<Kinds>{});
+                fields(in, node);
+                nodes.make<Kinds>(std::move(node));
+            }
+        }(), ...);
+    }
+
+    std::uint64_t cache_key(std::string_view source)
+    {
+        // the source's hash, salted with what decides what the compiler makes of it
+        const auto hash = llvm::xxHash64(llvm::StringRef(source.data(), source.size()));
+        std::string salted = MINIC_VERSION "/" MINIC_FRONTEND_HASH "/" + std::to_string(format_version) + "/";
+        salted.append(reinterpret_cast<const char*>(&hash), sizeof(hash));
+        return llvm::xxHash64(salted);
+    }
+}
+
+AstCache::AstCache(std::string dir, std::string_view source)
+    : dir(std::move(dir)), source(source), key(cache_key(source))
+{
+    llvm::SmallString<128> name(this->dir);
+    std::string file;
+    llvm::raw_string_ostream(file) << llvm::format_hex_no_prefix(key, 16) << ".ast";
+    llvm::sys::path::append(name, file);
+    path = std::string(name);
+}
+
+std::optional<AST::TranslationUnit> AstCache::load(Interner& names) const
+{
+    // mapped, unless it's small enough that reading it is cheaper
+    auto file = llvm::MemoryBuffer::getFile(path, false, false);
+    if (!file)
+    {
+        return std::nullopt;
+    }
+
+    const auto data = (*file)->getBuffer();
+    const Header expected;
+    Header header;
+    if (data.size() < sizeof(Header))
+    {
+        return std::nullopt;
+    }
+    std::memcpy(&header, data.data(), sizeof(Header));
+    if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.format != expected.format ||
+        header.byte_order != expected.byte_order || header.key != key || header.source_size != source.size())
+    {
+        return std::nullopt;
+    }
+
+    // a write cut short or a flipped bit would otherwise only show up as a broken tree
+    const auto payload = data.drop_front(sizeof(Header));
+    if (llvm::xxHash64(payload) != header.payload_hash)
+    {
+        return std::nullopt;
+    }
+
+    Reader in(payload);
+    std::uint32_t count = 0;
+    in(count);
+    for (std::uint32_t i = 0; i < count && !in.failed; ++i)
+    {
+        in.strings.emplace_back(in.bytes());
+    }
+
+    // interned in the order they were, so the symbols stored in the nodes come out the same
+    in(count);
+    for (std::uint32_t i = 0; i < count && !in.failed; ++i)
+    {
+        if (static_cast<std::uint32_t>(names.intern(in.bytes())) != i)
+        {
+            in.failed = true;
+        }
+    }
+    in.symbols = count;
+
+    AST::TranslationUnit unit;
+    read_nodes(in, unit.nodes, AllKinds{});
+    in(count);
+    if (count > in.remaining())
+    {
+        in.failed = true;
+    }
+    for (std::uint32_t i = 0; i < count && !in.failed; ++i)
+    {
+        in(unit.declarations.emplace_back());
+    }
+
+    if (in.failed || in.remaining() != 0)
+    {
+        return std::nullopt;
+    }
+    return unit;
+}
+
+bool AstCache::store(const AST::TranslationUnit& unit, const Interner& names) const
+{
+    Writer body;
+    write_nodes(body, unit.nodes, AllKinds{});
+    body(static_cast<std::uint32_t>(unit.size()));
+    for (const auto& declaration : unit)
+    {
+        body(declaration);
+    }
+
+    // the tables go first, the reader needs them for the nodes
+    Writer payload;
+    payload(static_cast<std::uint32_t>(body.strings.size()));
+    for (const auto string : body.strings)
+    {
+        payload.bytes(string);
+    }
+    payload(static_cast<std::uint32_t>(names.size()));
+    for (std::uint32_t i = 0; i < names.size(); ++i)
+    {
+        const auto spelling = names.spelling(static_cast<Symbol>(i));
+        payload.bytes(llvm::StringRef(spelling.data(), spelling.size()));
+    }
+    payload.out += body.out;
+
+    Header header;
+    header.key = key;
+    header.source_size = source.size();
+    header.payload_hash = llvm::xxHash64(payload.out);
+
+    if (const auto ec = llvm::sys::fs::create_directories(dir))
+    {
+        llvm::errs() << "couldn't create AST cache directory " << dir << ": " << ec.message() << "\n";
+        return false;
+    }
+
+    // written next to the entry and renamed over it, so builds running at the same time never see half of one
+    auto temp = llvm::sys::fs::TempFile::create(path + ".%%%%%%.tmp");
+    if (!temp)
+    {
+        llvm::errs() << "couldn't write AST cache entry " << path << ": " << llvm::toString(temp.takeError()) << "\n";
+        return false;
+    }
+
+    bool written;
+    {
+        llvm::raw_fd_ostream out(temp->FD, false);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        out << payload.out;
+        out.flush();
+        written = !out.has_error();
+        out.clear_error();
+    }
+
+    auto error = written ? temp->keep(path) : temp->discard();
+    if (!written || error)
+    {
+        const auto why = error ? llvm::toString(std::move(error)) : std::string("write failed");
+        llvm::errs() << "couldn't write AST cache entry " << path << ": " << why << "\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,40 @@
+#ifndef AST_CACHE_H
+#define AST_CACHE_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "ast.h"
+#include "interner.h"
+
+// the analyzed AST of a source file, kept on disk so an unchanged file skips the lexer, parser and semantic
+// analysis on its next build. an entry is named after a hash of the source, the compiler version and (when cmake
+// built it) the compiler's own sources, and holds the node arrays as they are after sema, the interner's
+// spellings and the strings the nodes use. entries are mapped and read back in one pass, a missing, stale or
+// damaged entry is just a miss
+class AstCache
+{
+public:
+    // dir is created when the first entry is stored; the source has to outlive the cache
+    AstCache(std::string dir, std::string_view source);
+
+    // the cached unit, with its identifiers interned into names in their original order (so every Symbol in
+    // it means what it did). names must not have anything interned yet past its seeded symbols
+    std::optional<AST::TranslationUnit> load(Interner& names) const;
+    // writes the entry for a unit that made it through semantic analysis; false (after reporting why) if it
+    // couldn't be written, which only costs the next build the time it would have saved
+    bool store(const AST::TranslationUnit& unit, const Interner& names) const;
+
+    const std::string& get_path() const { return path; }
+
+private:
+    std::string dir;
+    std::string_view source;
+    // of the source and the compiler version and sources
+    std::uint64_t key;
+    std::string path;
+};
+
+#endif // AST_CACHE_H
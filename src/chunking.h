@@ -0,0 +1,15 @@
+#ifndef CHUNKING_H
+#define CHUNKING_H
+
+#include <algorithm>
+#include <cstddef>
+
+// how many pieces ParallelLexer and ParallelParser cut size units of work (bytes, tokens) into for threads
+// threads: a few per thread, so one slow piece doesn't hold up the rest, none under min_chunk units and
+// always at least one
+inline std::size_t chunk_count_for(std::size_t size, std::size_t min_chunk, unsigned threads)
+{
+    return std::clamp<std::size_t>(size / std::max<std::size_t>(min_chunk, 1), 1, std::size_t{threads} * 4);
+}
+
+#endif // CHUNKING_H
@@ -2,37 +2,192 @@
 
 #include <iostream>
 
-Codegen::Codegen()
+#include "llvm/ADT/Any.h"
+#include "llvm/IR/PassInstrumentation.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Target/TargetMachine.h"
+
+namespace
+{
+    // the host's target machine, so the passes get a real cost model (vectorization and unrolling
+    // decisions, and their remarks, mean little without one); nullptr if the host target isn't built in
+    std::unique_ptr<llvm::TargetMachine> create_host_machine(unsigned opt_level)
+    {
+        llvm::InitializeNativeTarget();
+        const auto triple = llvm::sys::getDefaultTargetTriple();
+        std::string error;
+        const auto target = llvm::TargetRegistry::lookupTarget(triple, error);
+        if (!target)
+        {
+            return nullptr;
+        }
+
+        llvm::SubtargetFeatures features;
+        llvm::StringMap<bool> host_features;
+        if (llvm::sys::getHostCPUFeatures(host_features))
+        {
+            for (const auto& feature : host_features)
+            {
+                features.AddFeature(feature.first(), feature.second);
+            }
+        }
+
+        const auto level = opt_level >= 3 ? llvm::CodeGenOpt::Aggressive : llvm::CodeGenOpt::Default;
+        return std::unique_ptr<llvm::TargetMachine>(target->createTargetMachine(triple, llvm::sys::getHostCPUName(),
+            features.getString(), llvm::TargetOptions(), llvm::None, llvm::None, level));
+    }
+
+    // "function foo" / "loop %whilecond in foo" style details for the time trace
+    std::string ir_unit_name(const llvm::Any& ir)
+    {
+        if (llvm::any_isa<const llvm::Module*>(ir))
+        {
+            return llvm::any_cast<const llvm::Module*>(ir)->getName().str();
+        }
+        if (llvm::any_isa<const llvm::Function*>(ir))
+        {
+            return llvm::any_cast<const llvm::Function*>(ir)->getName().str();
+        }
+        if (llvm::any_isa<const llvm::LazyCallGraph::SCC*>(ir))
+        {
+            return llvm::any_cast<const llvm::LazyCallGraph::SCC*>(ir)->getName();
+        }
+        if (llvm::any_isa<const llvm::Loop*>(ir))
+        {
+            return llvm::any_cast<const llvm::Loop*>(ir)->getName().str();
+        }
+        return "";
+    }
+}
+
+Codegen::Codegen(const Interner& names, const Options& options) : names(names), options(options)
 {
     context = std::make_unique<llvm::LLVMContext>();
     mod = std::make_unique<llvm::Module>("main", *context);
     builder = std::make_unique<llvm::IRBuilder<>>(*context);
 
+    if (options.debug_locations && options.lines)
+    {
+        debug_info = std::make_unique<llvm::DIBuilder>(*mod);
+        llvm::SmallString<128> directory;
+        llvm::sys::fs::current_path(directory);
+        debug_file = debug_info->createFile(options.source_name, directory);
+        debug_info->createCompileUnit(llvm::dwarf::DW_LANG_C, debug_file, "mini-c", options.opt_level > 0, "", 0,
+            "", llvm::DICompileUnit::LineTablesOnly);
+        mod->addModuleFlag(llvm::Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
+    }
+
     // map default types
-    type_to_llvm_ty["int"]   = llvm::Type::getInt32Ty(*context);
-    type_to_llvm_ty["char"]  = llvm::Type::getInt8Ty(*context);
-    type_to_llvm_ty["void"]  = llvm::Type::getVoidTy(*context);
+    type_to_llvm_ty[AST::Type::INT]   = llvm::Type::getInt32Ty(*context);
+    type_to_llvm_ty[AST::Type::CHAR]  = llvm::Type::getInt8Ty(*context);
+    type_to_llvm_ty[AST::Type::VOID]  = llvm::Type::getVoidTy(*context);
+}
+
+void Codegen::compile_translation_unit(const AST::TranslationUnit& unit)
+{
+    generate_translation_unit(unit);
+    print(llvm::outs());
+    // check if its generating good IR
+    if (!verify())
+    {
+        llvm::errs() << "Module verification failed! Please consider this a severe skill issue.\n";
+    }
 }
 
-void Codegen::compile_translation_unit(const std::vector<AST::DeclarationVariant> &declarations)
+void Codegen::generate_translation_unit(const AST::TranslationUnit& unit)
 {
-    for (auto & d : declarations)
+    nodes = &unit.nodes;
+    for (auto & d : unit.declarations)
     {
         generate(d);
     }
+    nodes = nullptr;
 
-    mod->print(llvm::outs(), nullptr);
-    // check if its generating good IR
-    if (llvm::verifyModule(*mod, &llvm::errs()))
+    if (debug_info)
     {
-        llvm::errs() << "Module verification failed! Please consider this a severe skill issue.\n";
+        debug_info->finalize();
+    }
+}
+
+bool Codegen::verify() const
+{
+    return !llvm::verifyModule(*mod, &llvm::errs());
+}
+
+void Codegen::optimize()
+{
+    if (options.opt_level == 0)
+    {
+        return;
+    }
+
+    llvm::TimeTraceScope trace("Codegen::optimize");
+    const auto machine = create_host_machine(options.opt_level);
+    if (machine)
+    {
+        mod->setTargetTriple(machine->getTargetTriple().str());
+        mod->setDataLayout(machine->createDataLayout());
+    }
+
+    // one span per pass run in --time-trace, like clang's -ftime-trace
+    llvm::PassInstrumentationCallbacks callbacks;
+    if (llvm::timeTraceProfilerEnabled())
+    {
+        callbacks.registerBeforeNonSkippedPassCallback([](llvm::StringRef pass, llvm::Any ir)
+        {
+            llvm::timeTraceProfilerBegin(pass, ir_unit_name(ir));
+        });
+        callbacks.registerAfterPassCallback([](llvm::StringRef, llvm::Any, const llvm::PreservedAnalyses&)
+        {
+            llvm::timeTraceProfilerEnd();
+        });
+        callbacks.registerAfterPassInvalidatedCallback([](llvm::StringRef, const llvm::PreservedAnalyses&)
+        {
+            llvm::timeTraceProfilerEnd();
+        });
     }
+
+    llvm::LoopAnalysisManager loops;
+    llvm::FunctionAnalysisManager functions;
+    llvm::CGSCCAnalysisManager sccs;
+    llvm::ModuleAnalysisManager modules;
+
+    llvm::PassBuilder passes(machine.get(), llvm::PipelineTuningOptions(), llvm::None, &callbacks);
+    passes.registerModuleAnalyses(modules);
+    passes.registerCGSCCAnalyses(sccs);
+    passes.registerFunctionAnalyses(functions);
+    passes.registerLoopAnalyses(loops);
+    passes.crossRegisterProxies(loops, functions, sccs, modules);
+
+    const auto level = options.opt_level == 1 ? llvm::OptimizationLevel::O1
+                     : options.opt_level == 2 ? llvm::OptimizationLevel::O2
+                     : llvm::OptimizationLevel::O3;
+    passes.buildPerModuleDefaultPipeline(level).run(*mod, modules);
+}
+
+void Codegen::print(llvm::raw_ostream& to) const
+{
+    mod->print(to, nullptr);
+}
+
+llvm::AllocaInst* Codegen::create_entry_alloca(llvm::Type* type, const llvm::Twine& name)
+{
+    llvm::BasicBlock& entry = builder->GetInsertBlock()->getParent()->getEntryBlock();
+    llvm::IRBuilder<> at_entry(&entry, last_alloca ? std::next(last_alloca->getIterator()) : entry.begin());
+    last_alloca = at_entry.CreateAlloca(type, nullptr, name);
+    return last_alloca;
 }
 
 
-llvm::Instruction* Codegen::sgen(const std::unique_ptr<AST::BlockStatement>& block)
+llvm::Instruction* Codegen::sgen(const AST::BlockStatement& block)
 {
-    for (const auto& s : block->statements)
+    for (const auto& s : (*nodes)[block.statements])
     {
         generate(s);
     }
@@ -40,35 +195,38 @@ llvm::Instruction* Codegen::sgen(const std::unique_ptr<AST::BlockStatement>& blo
     return nullptr; 
 }
 
-llvm::Instruction* Codegen::sgen(const std::unique_ptr<AST::PrintStatement>& s)
+llvm::Instruction* Codegen::sgen(const AST::PrintStatement& s)
 {
-    auto str_arg = std::get<AST::Literal>(s->value);
+    const auto& str_arg = (*nodes)[std::get<AST::Ref<AST::Literal>>(s.value)];
     const auto as_str = std::get<std::string>(str_arg.value);
     llvm::Value* as_llvm = builder->CreateGlobalStringPtr(as_str);
     return builder->CreateCall(printf_decl(), {as_llvm});
 }
 
-llvm::Instruction* Codegen::sgen(const std::unique_ptr<AST::VariableDecl>& a)
+llvm::Instruction* Codegen::sgen(const AST::VariableDecl& a)
 {
-    const auto alloca = builder->CreateAlloca(type_to_llvm_ty[a->type], nullptr, a->name);
-    llvm::Value* evaluated = generate(a->value);
-    variable_locations[a->name] = alloca;
+    const auto alloca = create_entry_alloca(type_to_llvm_ty[a.type], llvm::StringRef(names.spelling(a.name)));
+    llvm::Value* evaluated = generate(a.value);
+    variable_locations[a.name] = alloca;
     builder->CreateStore(evaluated, alloca);
     return alloca;
 }
 
-llvm::Instruction* Codegen::sgen(const std::unique_ptr<AST::ExpressionStatement>& e)
+llvm::Instruction* Codegen::sgen(const AST::ExpressionStatement& e)
 {
-    generate(e->expr);
+    generate(e.expr);
     return nullptr; // will this bite me
 }
 
-llvm::Function* Codegen::dgen(const std::unique_ptr<AST::FunctionDeclaration> &fd)
+llvm::Function* Codegen::dgen(const AST::FunctionDeclaration& fd)
 {
-    auto return_type = type_to_llvm_ty[fd->return_type];
+    const llvm::StringRef name = names.spelling(fd.name);
+    llvm::TimeTraceScope trace("Codegen::dgen", name);
+    auto return_type = type_to_llvm_ty[fd.return_type];
 
     auto arg_types = std::vector<llvm::Type*>{};
-    for (const auto& arg : fd->params)
+    const auto params = (*nodes)[fd.params];
+    for (const auto& arg : params)
     {
         arg_types.push_back(type_to_llvm_ty[arg.type]);
     }   
@@ -76,53 +234,72 @@ llvm::Function* Codegen::dgen(const std::unique_ptr<AST::FunctionDeclaration> &f
     llvm::Function* func = llvm::Function::Create(
         llvm::FunctionType::get(return_type, arg_types, false), // false = not vararg
         llvm::Function::ExternalLinkage,
-        fd->name,
+        name,
         *mod
     );
     
     // add the names to the arguments
     for (auto& arg : func->args())
     {
-        arg.setName(fd->params[arg.getArgNo()].name);
+        arg.setName(llvm::StringRef(names.spelling(params[arg.getArgNo()].name)));
+    }
+
+    if (debug_info)
+    {
+        // line tables only, so the subroutine type doesn't need the real signature
+        const auto line = options.lines->lookup(fd.location).line;
+        current_subprogram = debug_info->createFunction(debug_file, name, name, debug_file, line,
+            debug_info->createSubroutineType(debug_info->getOrCreateTypeArray({})), line,
+            llvm::DINode::FlagPrototyped, llvm::DISubprogram::SPFlagDefinition);
+        func->setSubprogram(current_subprogram);
     }
 
     llvm::BasicBlock* bb = llvm::BasicBlock::Create(*context, "entry", func);
     builder->SetInsertPoint(bb);    
+    last_alloca = nullptr;
+    set_location(fd.location);
  
     // promote arguments to variables and store them
     for (auto& arg : func->args())
     {
-        const auto alloca = builder->CreateAlloca(arg.getType(), nullptr, arg.getName() + "_asalloca");
+        const auto alloca = create_entry_alloca(arg.getType(), arg.getName() + "_asalloca");
         builder->CreateStore(&arg, alloca);
-        variable_locations[arg.getName().str()] = alloca;
+        variable_locations[params[arg.getArgNo()].name] = alloca;
     }
     
-    generate(AST::StatementVariant{std::move(fd->body)});
+    generate(AST::StatementVariant{fd.body});
 
-    if (fd->return_type == "void")
+    if (fd.return_type == AST::Type::VOID)
     {
         builder->CreateRetVoid();
     }
 
-    declared_functions[fd->name] = func;
+    if (debug_info)
+    {
+        debug_info->finalizeSubprogram(current_subprogram);
+        current_subprogram = nullptr;
+        builder->SetCurrentDebugLocation(llvm::DebugLoc());
+    }
+
+    declared_functions[fd.name] = func;
     return func;
 }
 
-llvm::Instruction *Codegen::sgen(const std::unique_ptr<AST::ReturnStatement> &r)
+llvm::Instruction *Codegen::sgen(const AST::ReturnStatement& r)
 {
-    if (r->value.has_value()) {
-        llvm::Value* ret_val = generate(r->value.value());
+    if (r.value.has_value()) {
+        llvm::Value* ret_val = generate(r.value.value());
         return builder->CreateRet(ret_val);
     } else {
         return builder->CreateRetVoid();
     }
 }
 
-llvm::Instruction* Codegen::sgen(const std::unique_ptr<AST::IfElseStatement>& e)
+llvm::Instruction* Codegen::sgen(const AST::IfElseStatement& e)
 {
     // any value that is non-zero is true in C
-    static auto zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0);
-    auto condition_value = generate(e->condition); 
+    const auto zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0);
+    auto condition_value = generate(e.condition); 
 
     auto condition = builder->CreateICmpNE(condition_value, zero, "ifcond");
 
@@ -137,14 +314,14 @@ llvm::Instruction* Codegen::sgen(const std::unique_ptr<AST::IfElseStatement>& e)
 
     // move to the if body
     builder->SetInsertPoint(if_block);
-    generate(e->if_body);
+    generate(e.if_body);
     // jump back to the merge point to continue normal execution
     builder->CreateBr(merge_block);
     if_block = builder->GetInsertBlock(); // update the current block (llvm internal thing?)
 
     // create else body
     builder->SetInsertPoint(else_block);
-    generate(e->else_body); 
+    generate(e.else_body); 
     // return control flow (to merge point)
     builder->CreateBr(merge_block);
     else_block = builder->GetInsertBlock(); // update current block (llvm internal thing?)
@@ -155,10 +332,10 @@ llvm::Instruction* Codegen::sgen(const std::unique_ptr<AST::IfElseStatement>& e)
     return nullptr;
 }
 
-llvm::Instruction* Codegen::sgen(const std::unique_ptr<AST::WhileStatement>& w)
+llvm::Instruction* Codegen::sgen(const AST::WhileStatement& w)
 {
     // any value that is non-zero is true in C
-    static auto zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0);
+    const auto zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0);
     
     // define our basic blocks
     llvm::Function* current_function = builder->GetInsertBlock()->getParent();
@@ -169,14 +346,14 @@ llvm::Instruction* Codegen::sgen(const std::unique_ptr<AST::WhileStatement>& w)
     builder->CreateBr(while_cond); // jump to condition check first
     
     builder->SetInsertPoint(while_cond);
-    auto condition = generate(w->condition); 
+    auto condition = generate(w.condition); 
     auto condition_as_bool = builder->CreateICmpNE(condition, zero, "whilecond");
     builder->CreateCondBr(condition_as_bool, body_block, merge_point);    
     while_cond = builder->GetInsertBlock(); // update current block (llvm internal thing?)
 
     // generate the body
     builder->SetInsertPoint(body_block);
-    generate(w->body);
+    generate(w.body);
     builder->CreateBr(while_cond);
     // update and exit loop 
     body_block = builder->GetInsertBlock(); // update current block (llvm internal thing?)
@@ -224,11 +401,11 @@ llvm::Value *Codegen::gen(const AST::Literal &lit)
 
 llvm::Value* Codegen::gen(const AST::Variable& var)
 {
-    const auto allocation = variable_locations[var.name.value];
+    const auto allocation = variable_locations[var.name];
     llvm::Value* loadedVal = builder->CreateLoad(
         allocation->getAllocatedType(),  // type of value stored
         allocation,                       // pointer to load from
-        "load" + var.name.value                        // optional name
+        "load" + llvm::StringRef(names.spelling(var.name))                        // optional name
     );
 
     // if we are just getting the address of the variable, return that
@@ -240,18 +417,18 @@ llvm::Value* Codegen::gen(const AST::Variable& var)
     return loadedVal;
 }
 
-llvm::Value* Codegen::gen(const std::unique_ptr<AST::Binary>& bin)
+llvm::Value* Codegen::gen(const AST::Binary& bin)
 {
-    if (bin->result_type != "int") return nullptr; // TODO: fix this to support more types
+    if (bin.result_type != AST::Type::INT) return nullptr; // TODO: fix this to support more types
 
     return generate_int_ops(bin);
 }
 
-llvm::Value* Codegen::generate_unary_int_ops(const std::unique_ptr<AST::Unary>& un)
+llvm::Value* Codegen::generate_unary_int_ops(const AST::Unary& un)
 {
-    const auto rhs = generate(un->operand);
+    const auto rhs = generate(un.operand);
 
-    switch (un->op)
+    switch (un.op)
     {
     case TokenType::MINUS:
     {
@@ -266,11 +443,11 @@ llvm::Value* Codegen::generate_unary_int_ops(const std::unique_ptr<AST::Unary>&
     }
 }
 
-llvm::Value* Codegen::generate_unary_double_ops(const std::unique_ptr<AST::Unary>& un)
+llvm::Value* Codegen::generate_unary_double_ops(const AST::Unary& un)
 {
-    const auto rhs = generate(un->operand);
+    const auto rhs = generate(un.operand);
 
-    switch (un->op)
+    switch (un.op)
     {
     case TokenType::MINUS:
     {
@@ -285,57 +462,118 @@ llvm::Value* Codegen::generate_unary_double_ops(const std::unique_ptr<AST::Unary
     }
 }
 
-llvm::Value* Codegen::gen(const std::unique_ptr<AST::Unary>& un)
+llvm::Value* Codegen::gen(const AST::Unary& un)
 {
-    if (un->result_type != "int") return nullptr; // TODO: add more types
+    if (un.result_type != AST::Type::INT) return nullptr; // TODO: add more types
 
     return generate_unary_int_ops(un);
 }
 
-llvm::Value* Codegen::gen(const std::unique_ptr<AST::Assignment>& asn)
+llvm::Value* Codegen::gen(const AST::Assignment& asn)
 {
-    const auto rhs = generate(asn->rhs);
+    auto rhs = generate(asn.rhs);
     value_flag = false;
-    const auto lhs = generate(asn->lhs);
+    const auto lhs = generate(asn.lhs);
     value_flag = true;
+    // a += b stores a + b, sema only lets variables through so lhs is their alloca
+    if (const auto op = compound_operator(asn.op); op != TokenType::END_OF_FILE)
+    {
+        const auto slot = llvm::cast<llvm::AllocaInst>(lhs);
+        const auto current = builder->CreateLoad(slot->getAllocatedType(), slot, "compoundtmp");
+        rhs = create_int_op(op, current, rhs);
+    }
     builder->CreateStore(rhs, lhs);
     return rhs; 
 }
 
-llvm::Value* Codegen::gen(const std::unique_ptr<AST::Call>& call)
+llvm::Value* Codegen::gen(const AST::Call& call)
 {
     std::vector<llvm::Value*> args; 
-    for (auto& arg : call->args)
+    for (const auto& arg : (*nodes)[call.args])
     {
         args.push_back(generate(arg));
     }
 
-    return builder->CreateCall(declared_functions[call->func_name.value], args, "callresult");
+    return builder->CreateCall(declared_functions[call.func_name], args, "callresult");
 }
 
-llvm::Value* Codegen::gen(const std::unique_ptr<AST::StructAccess>& sa)
+llvm::Value* Codegen::gen(const AST::StructAccess& sa)
 {
     return nullptr;
 }
 
-llvm::Value* Codegen::gen(const std::unique_ptr<AST::ArrayAccess>& aa)
+llvm::Value* Codegen::gen(const AST::ArrayAccess& aa)
 {
     return nullptr;
 }
 
-llvm::Value* Codegen::generate_int_ops(const std::unique_ptr<AST::Binary>& bin)
+llvm::Value* Codegen::generate_int_ops(const AST::Binary& bin)
 {
-    const auto left = generate(bin->left);
-    const auto right = generate(bin->right);
+    if (bin.op == TokenType::AND || bin.op == TokenType::OR)
+    {
+        return generate_logical_ops(bin);
+    }
+
+    const auto left = generate(bin.left);
+    const auto right = generate(bin.right);
 
     if (!left || !right)
     {
         return nullptr;
     }
 
+    return create_int_op(bin.op, left, right);
+}
+
+llvm::Value* Codegen::generate_logical_ops(const AST::Binary& bin)
+{
+    // any value that is non-zero is true in C
+    const auto zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0);
+    const auto left = generate(bin.left);
+    if (!left)
+    {
+        return nullptr;
+    }
+    const auto left_as_bool = builder->CreateICmpNE(left, zero, "logiclhs");
+    // the left side alone decides it: false for &&, true for ||
+    const auto decided_block = builder->GetInsertBlock();
+
+    llvm::Function* current_function = decided_block->getParent();
+    auto rhs_block = llvm::BasicBlock::Create(*context, "logicrhs", current_function);
+    auto merge_block = llvm::BasicBlock::Create(*context, "logicend", current_function);
+    if (bin.op == TokenType::AND)
+    {
+        builder->CreateCondBr(left_as_bool, rhs_block, merge_block);
+    }
+    else
+    {
+        builder->CreateCondBr(left_as_bool, merge_block, rhs_block);
+    }
+
+    builder->SetInsertPoint(rhs_block);
+    const auto right = generate(bin.right);
+    if (!right)
+    {
+        return nullptr;
+    }
+    const auto right_as_bool = builder->CreateICmpNE(right, zero, "logicrhs");
+    builder->CreateBr(merge_block);
+    rhs_block = builder->GetInsertBlock(); // the right side may have added blocks of its own
+
+    builder->SetInsertPoint(merge_block);
+    const auto result = builder->CreatePHI(llvm::Type::getInt1Ty(*context), 2, "logictmp");
+    result->addIncoming(llvm::ConstantInt::getBool(*context, bin.op == TokenType::OR), decided_block);
+    result->addIncoming(right_as_bool, rhs_block);
+
+    // true is 1, like the comparisons in create_int_op
+    return builder->CreateZExt(result, llvm::Type::getInt32Ty(*context));
+}
+
+llvm::Value* Codegen::create_int_op(const TokenType op, llvm::Value* left, llvm::Value* right)
+{
     llvm::Value* result = nullptr; // store i1 before casting
 
-    switch (bin->op)
+    switch (op)
     {
     case TokenType::PLUS:
         result = builder->CreateAdd(left, right, "plustmp");
@@ -349,6 +587,9 @@ llvm::Value* Codegen::generate_int_ops(const std::unique_ptr<AST::Binary>& bin)
     case TokenType::SLASH:
         result = builder->CreateSDiv(left, right, "divtmp");
         break;
+    case TokenType::PERCENT:
+        result = builder->CreateSRem(left, right, "remtmp");
+        break;
     case TokenType::EQUAL_EQUAL:
         result = builder->CreateICmpEQ(left, right, "eqtmp");
         break;
@@ -367,32 +608,25 @@ llvm::Value* Codegen::generate_int_ops(const std::unique_ptr<AST::Binary>& bin)
     case TokenType::GREATER_EQUAL:
         result = builder->CreateICmpSGE(left, right, "greatereqtmp");
         break;
-
-    case TokenType::AND:
-        result = builder->CreateAnd(left, right, "andtmp");
-        break;
-    case TokenType::OR:
-        result = builder->CreateOr(left, right, "ortmp");
-        break;
     default:
         return nullptr;
     }
 
-    // Force cast to sign i32 before returning
-    return builder->CreateSExtOrBitCast(result, llvm::Type::getInt32Ty(*context));
+    // Force cast to i32 before returning, zero extended so a true comparison is 1 as in C
+    return builder->CreateZExtOrBitCast(result, llvm::Type::getInt32Ty(*context));
 }
 
-llvm::Value* Codegen::generate_precise_ops(const std::unique_ptr<AST::Binary>& bin)
+llvm::Value* Codegen::generate_precise_ops(const AST::Binary& bin)
 {
-    const auto left = generate(bin->left);
-    const auto right = generate(bin->right);
+    const auto left = generate(bin.left);
+    const auto right = generate(bin.right);
 
     if (!left || !right)
     {
         return nullptr;
     }
 
-    switch (bin->op)
+    switch (bin.op)
     {
     case TokenType::PLUS:
         return builder->CreateFAdd(left, right);
@@ -4,86 +4,144 @@
 #include "llvm/IR/Value.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/IR/DIBuilder.h"
 #include "ast.h"
+#include "stack.h"
 #include <unordered_map>
 #include <memory>
 
 class Codegen
 {
 public:
-    explicit Codegen();
+    struct Options
+    {
+        // 0 leaves the ir as generated, 1-3 run llvm's default -O1/-O2/-O3 pipelines in optimize()
+        unsigned opt_level = 0;
+        // attach line tables (!dbg) so optimization remarks can point back at the mini-c source, which
+        // needs lines for the source's line table
+        bool debug_locations = false;
+        const LineTable* lines = nullptr;
+        std::string source_name = "main.c";
+    };
+
+    // names spells the identifiers for llvm
+    explicit Codegen(const Interner& names) : Codegen(names, Options()) {}
+    Codegen(const Interner& names, const Options& options);
+
+    void compile_translation_unit(const AST::TranslationUnit& unit);
+
+    // the individual steps of compile_translation_unit, exposed so they can be driven (and measured) separately
+    void generate_translation_unit(const AST::TranslationUnit& unit);
+    bool verify() const;
+    // only meant for verified modules, the passes assume valid ir
+    void optimize();
+    void print(llvm::raw_ostream& to) const;
 
-    void compile_translation_unit(const std::vector<AST::DeclarationVariant>& declarations);
+    const llvm::Module& get_module() const { return *mod; }
+    // remark handlers are installed on this
+    llvm::LLVMContext& get_context() { return *context; }
 
 private:
     void generate(const AST::DeclarationVariant& d)
     {
-        std::visit([&](auto& x)
+        std::visit([&](auto x)
         {
-            dgen(x);
+            dgen((*nodes)[x]);
         }, d);
     }
 
+    // expressions and statements nest, see stack.h
     llvm::Instruction* generate(const AST::StatementVariant& s)
     {
-        static llvm::Instruction* last_visited = nullptr;
-        std::visit([&](auto& x) { last_visited = this->sgen(x); }, s);
-        return last_visited;
+        return run_with_stack([&]
+        {
+            return std::visit([&](auto x)
+            {
+                const auto& node = (*nodes)[x];
+                set_location(node.location);
+                return this->sgen(node);
+            }, s);
+        });
     }
 
     // useful visitor impl
     llvm::Value* generate(const AST::ExprVariant& e) 
     {
-        static llvm::Value* last_visited; 
-        std::visit([&](auto& x) { last_visited = this->gen(x); }, e);
-        return last_visited;
+        return run_with_stack([&]
+        {
+            return std::visit([&](auto x)
+            {
+                const auto& node = (*nodes)[x];
+                set_location(node.location);
+                return this->gen(node);
+            }, e);
+        });
+    }
+
+    // the !dbg location of everything built from here on (no-op without debug_locations)
+    void set_location(SourceLocation location)
+    {
+        if (current_subprogram)
+        {
+            const auto where = options.lines->lookup(location);
+            builder->SetCurrentDebugLocation(llvm::DILocation::get(*context, where.line, where.column, current_subprogram));
+        }
     }
 
-    auto printf_decl() const
+    // allocas go to the top of the entry block, in declaration order: mem2reg/sroa only promote those, and an
+    // alloca in a loop body would grow the stack on every iteration
+    llvm::AllocaInst* create_entry_alloca(llvm::Type* type, const llvm::Twine& name);
+
+    auto printf_decl()
     {
-        // 0 = default address space (this might be used for other things like gpu memory for example)
-        static llvm::FunctionType* prototype = llvm::FunctionType::get(llvm::Type::getInt32Ty(*context),
-            llvm::PointerType::get(llvm::Type::getInt8Ty(*context), 0), true);
-        static llvm::Function* printf_func = llvm::Function::Create(
-            prototype,
-            llvm::Function::ExternalLinkage, // external function
-            "printf",
-            *mod
-        );
-        static llvm::FunctionCallee printfCallee = mod->getOrInsertFunction(
-            "printf", prototype
-        );
-        return printfCallee;
+        // declared lazily, once per module (a static here would outlive the context it was created in)
+        if (!printf_callee)
+        {
+            // 0 = default address space (this might be used for other things like gpu memory for example)
+            llvm::FunctionType* prototype = llvm::FunctionType::get(llvm::Type::getInt32Ty(*context),
+                llvm::PointerType::get(llvm::Type::getInt8Ty(*context), 0), true);
+            printf_callee = mod->getOrInsertFunction("printf", prototype);
+        }
+        return printf_callee;
     }
 
     //declaration generators 
-    llvm::Function* dgen(const std::unique_ptr<AST::FunctionDeclaration>& fd);
+    llvm::Function* dgen(const AST::FunctionDeclaration& fd);
 
     // statement generators
-    llvm::Instruction* sgen(const std::unique_ptr<AST::ReturnStatement>& r);
-    llvm::Instruction* sgen(const std::unique_ptr<AST::BlockStatement>& block);
-    llvm::Instruction* sgen(const std::unique_ptr<AST::PrintStatement>& s);
-    llvm::Instruction* sgen(const std::unique_ptr<AST::VariableDecl>& a);
-    llvm::Instruction* sgen(const std::unique_ptr<AST::ExpressionStatement>& e);
-    llvm::Instruction* sgen(const std::unique_ptr<AST::IfElseStatement>& e);
-    llvm::Instruction* sgen(const std::unique_ptr<AST::WhileStatement>& e);
+    llvm::Instruction* sgen(const AST::ReturnStatement& r);
+    llvm::Instruction* sgen(const AST::BlockStatement& block);
+    llvm::Instruction* sgen(const AST::PrintStatement& s);
+    llvm::Instruction* sgen(const AST::VariableDecl& a);
+    llvm::Instruction* sgen(const AST::ExpressionStatement& e);
+    llvm::Instruction* sgen(const AST::IfElseStatement& e);
+    llvm::Instruction* sgen(const AST::WhileStatement& e);
     
     llvm::Value* gen(const AST::Literal& lit);
     llvm::Value* gen(const AST::Variable& var);
 
-    llvm::Value* gen(const std::unique_ptr<AST::Binary>& bin);
-    llvm::Value* generate_unary_int_ops(const std::unique_ptr<AST::Unary>& un);
-    llvm::Value* generate_unary_double_ops(const std::unique_ptr<AST::Unary>& un);
-    llvm::Value* gen(const std::unique_ptr<AST::Unary>& un);
-    llvm::Value* gen(const std::unique_ptr<AST::Assignment>& asn);
-    llvm::Value* gen(const std::unique_ptr<AST::Call>& call);
-    llvm::Value* gen(const std::unique_ptr<AST::StructAccess>& sa);
-    llvm::Value* gen(const std::unique_ptr<AST::ArrayAccess>& aa);
+    llvm::Value* gen(const AST::Binary& bin);
+    llvm::Value* generate_unary_int_ops(const AST::Unary& un);
+    llvm::Value* generate_unary_double_ops(const AST::Unary& un);
+    llvm::Value* gen(const AST::Unary& un);
+    llvm::Value* gen(const AST::Assignment& asn);
+    llvm::Value* gen(const AST::Call& call);
+    llvm::Value* gen(const AST::StructAccess& sa);
+    llvm::Value* gen(const AST::ArrayAccess& aa);
 
-    llvm::Value* generate_int_ops(const std::unique_ptr<AST::Binary>& bin);
-    llvm::Value* generate_precise_ops(const std::unique_ptr<AST::Binary>& bin);
+    llvm::Value* generate_int_ops(const AST::Binary& bin);
+    // && and ||, which only evaluate their right side if the left doesn't decide the result
+    llvm::Value* generate_logical_ops(const AST::Binary& bin);
+    // op (a binary operator) on two i32s
+    llvm::Value* create_int_op(TokenType op, llvm::Value* left, llvm::Value* right);
+    llvm::Value* generate_precise_ops(const AST::Binary& bin);
 
 private:
+    const Interner& names;
+    Options options;
+    // the nodes of the unit being generated
+    const AST::Nodes* nodes = nullptr;
+
     // for variables
     bool value_flag = true; 
 
@@ -94,11 +152,20 @@ private:
     // the "translation unit"
     std::unique_ptr<llvm::Module> mod; 
     // llvm types for creating variables
-    std::unordered_map<std::string, llvm::Type*> type_to_llvm_ty;
+    std::unordered_map<AST::Type, llvm::Type*> type_to_llvm_ty;
     // store variables that exist
-    std::unordered_map<std::string, llvm::AllocaInst*> variable_locations;
+    std::unordered_map<Symbol, llvm::AllocaInst*> variable_locations;
     // store function prototypes
-    std::unordered_map<std::string, llvm::Function*> declared_functions;
+    std::unordered_map<Symbol, llvm::Function*> declared_functions;
+    // external printf, see printf_decl()
+    llvm::FunctionCallee printf_callee;
+    // the last alloca of the current function, see create_entry_alloca()
+    llvm::AllocaInst* last_alloca = nullptr;
+
+    // line tables, only with options.debug_locations
+    std::unique_ptr<llvm::DIBuilder> debug_info;
+    llvm::DIFile* debug_file = nullptr;
+    llvm::DISubprogram* current_subprogram = nullptr;
 };
 
 
@@ -1,9 +1,17 @@
 #include "error.h"
 
 static ErrorMode state = ErrorMode::NO_ERR; 
+// innermost live capture on this thread, if any
+static thread_local ErrorCapture* current_capture = nullptr;
 
 void report_err(std::ostream& to, const std::string& what)
 {
+    if (current_capture)
+    {
+        current_capture->messages.push_back(what);
+        return;
+    }
+
     to << "\033[31merror\033[37m: " << what << "\n";
     state = ErrorMode::ERR;
 }
@@ -11,4 +19,37 @@ void report_err(std::ostream& to, const std::string& what)
 ErrorMode get_err() 
 {
     return state;
-}
\ No newline at end of file
+}
+
+ErrorCapture::ErrorCapture()
+    : outer(current_capture)
+{
+    current_capture = this;
+}
+
+ErrorCapture::~ErrorCapture()
+{
+    current_capture = outer;
+}
+
+ErrorCapture* ErrorCapture::active()
+{
+    return current_capture;
+}
+
+void ErrorCapture::set_active(ErrorCapture* capture)
+{
+    current_capture = capture;
+}
+
+void ErrorCapture::replay(std::ostream& to) const
+{
+    // report past this capture, or the messages would land right back in it
+    const auto active = current_capture;
+    current_capture = outer;
+    for (const auto& what : messages)
+    {
+        report_err(to, what);
+    }
+    current_capture = active;
+}
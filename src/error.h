@@ -2,6 +2,8 @@
 #define ERROR_H
 
 #include <ostream> 
+#include <string>
+#include <vector>
 
 enum class ErrorMode 
 {
@@ -11,4 +13,32 @@ enum class ErrorMode
 void report_err(std::ostream& to, const std::string& what); 
 extern ErrorMode get_err(); 
 
-#endif
\ No newline at end of file
+// while alive, errors reported on the thread that created it are collected here instead of printed, and
+// don't count towards get_err() until they're replayed (for phases that run speculatively, e.g. under a fuzzer)
+class ErrorCapture
+{
+public:
+    ErrorCapture();
+    ~ErrorCapture();
+    ErrorCapture(const ErrorCapture&) = delete;
+    ErrorCapture& operator=(const ErrorCapture&) = delete;
+
+    bool failed() const { return !messages.empty(); }
+    const std::vector<std::string>& get_messages() const { return messages; }
+
+    // reports the collected errors for real (into the enclosing capture, if there is one)
+    void replay(std::ostream& to) const;
+
+    // the capture errors reported on this thread go to (nullptr if they're printed). work handed to another
+    // thread, with this one waiting for it, makes it that thread's too so its errors land in the same place
+    static ErrorCapture* active();
+    static void set_active(ErrorCapture* capture);
+
+private:
+    friend void report_err(std::ostream& to, const std::string& what);
+
+    std::vector<std::string> messages;
+    ErrorCapture* outer;
+};
+
+#endif
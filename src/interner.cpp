@@ -0,0 +1,21 @@
+#include "interner.h"
+
+#include <cassert>
+
+Interner::Interner()
+{
+    // in the order of the seeded Symbol enumerators
+    intern("printf");
+    intern("main");
+    assert(spelling(Symbol::MAIN) == "main");
+}
+
+Symbol Interner::intern(std::string_view spelling)
+{
+    const auto [entry, inserted] = table.try_emplace(spelling, static_cast<Symbol>(spellings.size()));
+    if (inserted)
+    {
+        spellings.push_back(entry->getKey());
+    }
+    return entry->second;
+}
@@ -0,0 +1,38 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
+
+// identifiers are interned once, by the lexer, and every later phase compares and hashes the 32-bit ids.
+// the first few are seeded with names the compiler itself looks for.
+enum class Symbol : std::uint32_t
+{
+    PRINTF,
+    MAIN,
+    NONE = UINT32_MAX // tokens that aren't identifiers
+};
+
+class Interner
+{
+public:
+    Interner();
+    Interner(const Interner&) = delete;
+    Interner& operator=(const Interner&) = delete;
+
+    // the same id for the same spelling, every time; the spelling is copied, so it may be transient
+    Symbol intern(std::string_view spelling);
+    std::string_view spelling(Symbol symbol) const { return spellings[static_cast<std::uint32_t>(symbol)]; }
+    std::size_t size() const { return spellings.size(); }
+
+private:
+    llvm::StringMap<Symbol, llvm::BumpPtrAllocator> table;
+    // by id, pointing at the keys in the table (which never move)
+    std::vector<std::string_view> spellings;
+};
+
+#endif // INTERNER_H
@@ -1,199 +1,207 @@
 #include "lexer.h"
 #include "error.h"
+#include "scan.h"
+#include <array>
 #include <iostream>
 #include <sstream>
 
-Lexer::Lexer(const std::string &file)
-    : file(file)
+namespace
 {
-}
+    constexpr TokenType keywords[] = {
+        TokenType::IF, TokenType::ELSE, TokenType::WHILE, TokenType::FOR, TokenType::RETURN, TokenType::INT,
+        TokenType::CHAR, TokenType::VOID, TokenType::STRUCT, TokenType::BREAK, TokenType::CONTINUE
+    };
+
+    // perfect over the keywords above (checked below): first char, last char and length pick the slot, so
+    // classifying an identifier is one table load and at most one compare against the keyword's spelling
+    constexpr std::size_t keyword_slots = 16;
+    constexpr std::size_t keyword_hash(std::string_view word)
+    {
+        const auto first = static_cast<unsigned char>(word.front());
+        const auto last = static_cast<unsigned char>(word.back());
+        return (first + last * 12 + word.size()) % keyword_slots;
+    }
 
-const std::vector<Token>& Lexer::lex()
-{
-    for (curr_char = 0; curr_char < file.size();) 
+    // END_OF_FILE marks a free slot
+    constexpr auto keyword_table = []
     {
-        switch (auto ch = consume())
+        std::array<TokenType, keyword_slots> table{};
+        table.fill(TokenType::END_OF_FILE);
+        for (const auto keyword : keywords)
         {
-        case '\n':
-            ++line; 
-            break;
-            
-        case ' ':
-        case '\r':
-        case '\t':
-            break; // skip 
-        
-        /* SINGLE CHARACTER TOKENS */                
-
-        case '(': tokens.push_back(Token{TokenType::LEFT_PAREN, "(", line}); break;
-        case ')': tokens.push_back(Token{TokenType::RIGHT_PAREN, ")", line}); break;
-        case '{': tokens.push_back(Token{TokenType::LEFT_BRACE, "{", line}); break;
-        case '}': tokens.push_back(Token{TokenType::RIGHT_BRACE, "}", line}); break;
-        case ',': tokens.push_back(Token{TokenType::COMMA, ",", line}); break;
-        case '.': tokens.push_back(Token{TokenType::DOT, ".", line}); break;
-        case ';': tokens.push_back(Token{TokenType::SEMICOLON, ";", line}); break;
-        case '%': tokens.push_back(Token{TokenType::PERCENT, "%", line}); break;
-        case '[': tokens.push_back(Token{TokenType::LEFT_SBRACKET, "[", line}); break;
-        case ']': tokens.push_back(Token{TokenType::RIGHT_SBRACKET, "]", line}); break;
-
-            /* SPECIAL CASES */
-        case '!':
-            if (check('='))
-            {
-                tokens.push_back(Token{TokenType::BANG_EQUAL, "!=", line});
-            }
-            else
-            {
-                tokens.push_back(Token{TokenType::BANG, "!", line});
-            }
-            break;
+            table[keyword_hash(token_spelling(keyword))] = keyword;
+        }
+        return table;
+    }();
 
-        case '>':
-            if (check('='))
-            {
-                tokens.push_back(Token{TokenType::GREATER_EQUAL, ">=", line});
-            }
-            else
-            {
-                tokens.push_back(Token{TokenType::GREATER, ">", line});
-            }
-            break;
+    constexpr bool keyword_hash_is_perfect()
+    {
+        for (const auto keyword : keywords)
+        {
+            if (keyword_table[keyword_hash(token_spelling(keyword))] != keyword) return false;
+        }
+        return true;
+    }
+    static_assert(keyword_hash_is_perfect(), "keyword_hash collides, pick new constants when adding keywords");
 
-        case '<':
-            if (check('='))
-            {
-                tokens.push_back(Token{TokenType::LESS_EQUAL, "<=", line});
-            }
-            else
-            {
-                tokens.push_back(Token{TokenType::LESS, "<", line});
-            }
-            break;
+    // IDENTIFIER if the word isn't a keyword
+    constexpr TokenType classify_word(std::string_view word)
+    {
+        const auto candidate = keyword_table[keyword_hash(word)];
+        if (candidate != TokenType::END_OF_FILE && token_spelling(candidate) == word)
+        {
+            return candidate;
+        }
+        return TokenType::IDENTIFIER;
+    }
+    static_assert(classify_word("while") == TokenType::WHILE && classify_word("whale") == TokenType::IDENTIFIER);
 
-        case '+':
-            if (check('='))
-            {
-                tokens.push_back(Token{TokenType::PLUS_EQUAL, "+=", line});
-            }
-            else
-            {
-                tokens.push_back(Token{TokenType::PLUS, "+", line});
-            }
-            break;
+    // one lookup per byte decides how the lexer goes on; no <cctype>, so the locale doesn't matter
+    constexpr auto char_table = []
+    {
+        std::array<Lexer::CharInfo, 256> table{};
+        const auto set_operator = [&](char c, TokenType single, TokenType with_equal, TokenType doubled)
+        {
+            table[static_cast<unsigned char>(c)] = {CharKind::OPERATOR, single, with_equal, doubled};
+        };
+        constexpr auto none = TokenType::END_OF_FILE;
+
+        for (const char c : {' ', '\t', '\r', '\n'}) table[static_cast<unsigned char>(c)].kind = CharKind::SPACE;
+        for (int c = 'a'; c <= 'z'; ++c) table[c].kind = CharKind::ALPHA;
+        for (int c = 'A'; c <= 'Z'; ++c) table[c].kind = CharKind::ALPHA;
+        for (int c = '0'; c <= '9'; ++c) table[c].kind = CharKind::DIGIT;
+        table['"'].kind = CharKind::DOUBLE_QUOTE;
+        table['\''].kind = CharKind::SINGLE_QUOTE;
+
+        // character     alone                      followed by =               doubled
+        set_operator('(', TokenType::LEFT_PAREN,     none,                      none);
+        set_operator(')', TokenType::RIGHT_PAREN,    none,                      none);
+        set_operator('{', TokenType::LEFT_BRACE,     none,                      none);
+        set_operator('}', TokenType::RIGHT_BRACE,    none,                      none);
+        set_operator(',', TokenType::COMMA,          none,                      none);
+        set_operator('.', TokenType::DOT,            none,                      none);
+        set_operator(';', TokenType::SEMICOLON,      none,                      none);
+        set_operator('%', TokenType::PERCENT,        TokenType::PERCENT_EQUAL,  none);
+        set_operator('[', TokenType::LEFT_SBRACKET,  none,                      none);
+        set_operator(']', TokenType::RIGHT_SBRACKET, none,                      none);
+        set_operator('!', TokenType::BANG,           TokenType::BANG_EQUAL,     none);
+        set_operator('>', TokenType::GREATER,        TokenType::GREATER_EQUAL,  none);
+        set_operator('<', TokenType::LESS,           TokenType::LESS_EQUAL,     none);
+        set_operator('+', TokenType::PLUS,           TokenType::PLUS_EQUAL,     none);
+        set_operator('-', TokenType::MINUS,          TokenType::MINUS_EQUAL,    none);
+        set_operator('*', TokenType::STAR,           TokenType::STAR_EQUAL,     none);
+        set_operator('/', TokenType::SLASH,          TokenType::SLASH_EQUAL,    none); // "//" is handled by lex()
+        set_operator('=', TokenType::EQUAL,          TokenType::EQUAL_EQUAL,    none);
+        set_operator('&', none,                      none,                      TokenType::AND);
+        set_operator('|', none,                      none,                      TokenType::OR);
+        return table;
+    }();
+}
 
-        case '-':
-            if (check('='))
-            {
-                tokens.push_back(Token{TokenType::MINUS_EQUAL, "-=", line});
-            }
-            else
-            {
-                tokens.push_back(Token{TokenType::MINUS, "-", line});
-            }
-            break;
+Lexer::Lexer(std::string_view file, Interner& names)
+    : file(file), names(names), tokens(file, names), lines(&tokens.get_lines())
+{
+}
 
-        case '*':
-            if (check('='))
-            {
-                tokens.push_back(Token{TokenType::STAR_EQUAL, "*=", line});
-            }
-            else
-            {
-                tokens.push_back(Token{TokenType::STAR, "*", line});
-            }
+Lexer::Lexer(std::string_view file, Interner& names, std::size_t start, const LineTable& lines)
+    : file(file), names(names), tokens(file, names), lines(&lines), curr_char(start)
+{
+}
+
+Token Lexer::next()
+{
+    produced = false;
+    while (!produced && curr_char < file.size()) 
+    {
+        token_start = curr_char;
+        const auto ch = consume();
+        const auto& info = char_table[static_cast<unsigned char>(ch)];
+        switch (info.kind)
+        {
+        case CharKind::SPACE:
+            // skip the whole run at once
+            curr_char = scan::skip_whitespace(file, curr_char);
             break;
 
-        case '/':
-            if (check('='))
-            {
-                tokens.push_back(Token{TokenType::SLASH_EQUAL, "/=", line});
-            }
-            else if (check('/'))
+        case CharKind::OPERATOR:
+            if (ch == '/' && check('/'))
             {
-                // remove comment 
-                while (curr_char < file.size() && consume() != '\n')
-                {
-                }
+                // remove comment
+                curr_char = scan::find(file, curr_char, '\n');
             }
             else
             {
-                tokens.push_back(Token{TokenType::SLASH, "/", line});
-            }
-            break;
-        
-        case '=': 
-            if (check('=')) 
-            {
-                tokens.push_back(Token{TokenType::EQUAL_EQUAL, "==", line}); 
-            }
-            else 
-            {
-                tokens.push_back(Token{TokenType::EQUAL, "==", line}); 
+                operator_token(ch, info);
             }
             break;
 
-        case '&': 
-            if (check('&')) 
-            {
-                tokens.push_back(Token{TokenType::AND, "&&", line});
-            } 
-            else 
-            {
-                std::ostringstream ss; 
-                ss << "Expected & after & on line: " << line << "\n"; 
-                report_err(std::cout, ss.str()); 
-            }
-            break; 
-
-        case '|':
-            if (check('|'))
-            {
-                tokens.push_back(Token{TokenType::OR, "||", line}); 
-            } 
-            else 
-            {
-                std::ostringstream ss; 
-                ss << "Expected | after | on line: " << line << "\n"; 
-                report_err(std::cout, ss.str()); 
-            }
-            break; 
             /* MULTI CHAR TOKENS */
-        default:
-            /* IDENTIFIERS AND KW */
-            if (std::isalpha(ch)) 
-            {
-                keyword(ch); break;
-            }
-            /* NUMBERS */
-            else if (std::isdigit(ch))
-            {
-                number(ch); break;
-            }
-            /* STRINGS */
-            else if (ch == '"')
-            {
-                string(); break;
-            }
-            /* CHARS */
-            else if (ch == '\'')
-            {
-                _char(); break;
-            }
+        case CharKind::ALPHA: keyword(); break;
+        case CharKind::DIGIT: number(); break;
+        case CharKind::DOUBLE_QUOTE: string(); break;
+        case CharKind::SINGLE_QUOTE: _char(); break;
 
+        case CharKind::OTHER:
+        {
             std::ostringstream ss; 
-            ss << "Unexpected token \"" << ch << "\" on line: " << line << "\n"; 
-            report_err(std::cout, ss.str());
+            ss << "Unexpected token \"" << ch << "\" on line: " << where() << "\n"; 
+            error(ss.str());
             break;
         }
+        }
+    }
+
+    if (!produced)
+    {
+        token_start = file.size();
+        emit(TokenType::END_OF_FILE, "");
+    }
+
+    ++counters.by_type[static_cast<std::size_t>(current.type)];
+    return current;
+}
+
+const TokenBuffer& Lexer::lex()
+{
+    for (;;)
+    {
+        const auto t = next();
+        tokens.push(t);
+        if (t.type == TokenType::END_OF_FILE)
+        {
+            return tokens;
+        }
     }
+}
 
-    tokens.push_back(Token{
-        .type = TokenType::END_OF_FILE, 
-        .value = "",
-        .line = line, 
-    });
+void Lexer::error(const std::string& what)
+{
+    ++errors;
+    report_err(std::cout, what);
+}
 
-    return tokens;
+void Lexer::operator_token(char ch, const CharInfo& info)
+{
+    // longest match first: "x=", then "xx", then "x" alone
+    if (info.with_equal != TokenType::END_OF_FILE && check('='))
+    {
+        add(info.with_equal);
+    }
+    else if (info.doubled != TokenType::END_OF_FILE && check(ch))
+    {
+        add(info.doubled);
+    }
+    else if (info.single != TokenType::END_OF_FILE)
+    {
+        add(info.single);
+    }
+    else
+    {
+        // only & and | have no single character meaning (yet)
+        std::ostringstream ss; 
+        ss << "Expected " << ch << " after " << ch << " on line: " << where() << "\n"; 
+        error(ss.str()); 
+    }
 }
 
 bool Lexer::check(char c)
@@ -213,99 +221,86 @@ const char Lexer::consume()
     return file[curr_char++];
 }
 
-void Lexer::keyword(char seed)
+void Lexer::keyword()
 {
-    std::string result(1, seed);  
-    while (curr_char < file.size() && std::isalnum(file[curr_char])) 
-    {
-        result += consume(); 
-    }
+    const auto start = curr_char - 1; // its first character was already consumed
+    curr_char = scan::skip_alnum(file, curr_char);
 
-    auto is_keyword = keyword_to_token_type.find(result);
-    if (is_keyword != keyword_to_token_type.end())
+    const auto result = file.substr(start, curr_char - start);
+    if (const auto type = classify_word(result); type != TokenType::IDENTIFIER)
     {
-        tokens.push_back(Token{is_keyword->second, is_keyword->first, line});
+        add(type);
         return; // put in a keyword instead
     }
 
-    tokens.push_back(Token{TokenType::IDENTIFIER, result, line}); 
+    emit(TokenType::IDENTIFIER, result, names.intern(result)); 
 }
 
 
-void Lexer::number(char c)
+void Lexer::number()
 {
-    std::string result(1, c);
+    const auto start = curr_char - 1; // its first digit was already consumed
 
     // Read the integer part
-    while (curr_char < file.size() && std::isdigit(file[curr_char]))
-    {
-        result += consume();
-    }
+    curr_char = scan::skip_digits(file, curr_char);
 
     if (curr_char < file.size() && file[curr_char] == '.')
     {
-        result += consume();
+        ++curr_char;
 
-        if (curr_char >= file.size() || !std::isdigit(file[curr_char]))
+        if (curr_char >= file.size() || char_table[static_cast<unsigned char>(file[curr_char])].kind != CharKind::DIGIT)
         {
             std::ostringstream ss;
-            ss << "Malformed number on line: " << line << "\n";
-            report_err(std::cout, ss.str());
+            ss << "Malformed number on line: " << where() << "\n";
+            error(ss.str());
             return;
         }
 
-        while (curr_char < file.size() && std::isdigit(file[curr_char]))
-        {
-            result += consume();
-        }
-
-        tokens.push_back(Token{TokenType::NUMBER, result, line});
-    }
-    else
-    {
-        tokens.push_back(Token{TokenType::NUMBER, result, line});
+        curr_char = scan::skip_digits(file, curr_char);
     }
+
+    emit(TokenType::NUMBER, file.substr(start, curr_char - start));
 }
 
 void Lexer::string()
 {
-    std::string result;  
-    while (curr_char < file.size() && file[curr_char] != '"') 
-    {
-        result += consume(); 
-    }
+    const auto start = curr_char; // just past the opening quote
+    curr_char = scan::find(file, curr_char, '"'); // strings may span lines
 
     if (curr_char >= file.size())
     {
+        open_literal = true;
         std::ostringstream ss; 
-        ss << "Unterminated string literal on line: " << line << "\n";
-        report_err(std::cout, ss.str()); 
+        ss << "Unterminated string literal on line: " << where() << "\n";
+        error(ss.str()); 
         return;
     }
 
-    tokens.push_back(Token{TokenType::STRING, result, line});
+    emit(TokenType::STRING, file.substr(start, curr_char - start));
 
     consume(); // the outer quote
 }
 
 void Lexer::_char()
 {
-    std::string value; 
+    const auto start = curr_char;
     if (curr_char < file.size() && file[curr_char] != '\'')
     {
-        value += consume(); 
+        ++curr_char; 
     }
+    const auto value = file.substr(start, curr_char - start);
     
     if (curr_char < file.size() && file[curr_char] == '\'')
     {
         consume(); 
-        tokens.push_back(Token{TokenType::CHAR, value, line});
+        emit(TokenType::CHAR, value);
         return;
     }
 
+    open_literal = curr_char >= file.size();
     std::ostringstream ss; 
-    ss << "Invalid character literal on line " << line << "\n"; 
-    report_err(std::cout, ss.str()); 
+    ss << "Invalid character literal on line " << where() << "\n"; 
+    error(ss.str()); 
 }
 
 void print_token(const Token &t)
@@ -313,7 +308,7 @@ void print_token(const Token &t)
     std::cout << "Token(" 
             << "Type: " << stringify_token_type(t.type) << ", "
             << "Value: \"" << t.value << "\", "
-            << "Line: " << t.line 
+            << "Offset: " << t.location.offset 
             << ")\n";
 }
 
@@ -345,6 +340,7 @@ std::string stringify_token_type(const TokenType type)
         case TokenType::MINUS_EQUAL: return "MINUS_EQUAL";
         case TokenType::STAR_EQUAL: return "STAR_EQUAL";
         case TokenType::SLASH_EQUAL: return "SLASH_EQUAL";
+        case TokenType::PERCENT_EQUAL: return "PERCENT_EQUAL";
         case TokenType::IDENTIFIER: return "IDENTIFIER";
         case TokenType::NUMBER: return "NUMBER";
         case TokenType::STRING: return "STRING";
@@ -2,108 +2,90 @@
 #define LEXER_H 
 
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector> 
+#include "interner.h"
+#include "token.h"
+#include "token_buffer.h"
 
-enum class TokenType {
-    // Single-character tokens
-    LEFT_PAREN,     // (
-    RIGHT_PAREN,    // )
-    LEFT_BRACE,     // {
-    RIGHT_BRACE,    // }
-    COMMA,          // ,
-    DOT,            // .
-    SEMICOLON,      // ;
-    PLUS,           // +
-    MINUS,          // -
-    STAR,           // *
-    SLASH,          // /
-    PERCENT,        // %
-    LEFT_SBRACKET,
-    RIGHT_SBRACKET, 
-    // One or two character tokens
-    BANG,           // !
-    BANG_EQUAL,     // !=
-    EQUAL,          // =
-    EQUAL_EQUAL,    // ==
-    GREATER,        // >
-    GREATER_EQUAL,  // >=
-    LESS,           // <
-    LESS_EQUAL,     // <=
-    PLUS_EQUAL,     // +=
-    MINUS_EQUAL,    // -=
-    STAR_EQUAL,     // *=
-    SLASH_EQUAL,    // /=
-    AND, 
-    OR,
-
-    // Literals
-    IDENTIFIER,
-    NUMBER,
-    STRING,
-
-    // Keywords
-    IF,
-    ELSE,
-    WHILE,
-    FOR,
-    RETURN,
-    INT,
-    CHAR,
-    VOID,
-    STRUCT,
-    BREAK,
-    CONTINUE,
-
-    // End of file
-    END_OF_FILE
-};
-
+void print_token(const Token& t); 
+std::string stringify_token_type(const TokenType t); 
 
-struct Token 
+// what a byte can start, see char_table in lexer.cpp
+enum class CharKind : unsigned char
 {
-    TokenType type; 
-    std::string value;
-    std::size_t line;  
+    OTHER, SPACE, ALPHA, DIGIT, DOUBLE_QUOTE, SINGLE_QUOTE, OPERATOR
 };
 
-void print_token(const Token& t); 
-std::string stringify_token_type(const TokenType t); 
-
 class Lexer 
 {
 public: 
-    explicit Lexer(const std::string& file);
+    struct CharInfo
+    {
+        CharKind kind = CharKind::OTHER;
+        // for operators: the token for the character alone, followed by '=', and doubled ("&&"); END_OF_FILE
+        // where that spelling isn't a token
+        TokenType single = TokenType::END_OF_FILE;
+        TokenType with_equal = TokenType::END_OF_FILE;
+        TokenType doubled = TokenType::END_OF_FILE;
+    };
+
+    // tokens produced so far, by type (for --stats, the tokens themselves may be long gone when streaming)
+    struct Counters
+    {
+        std::size_t by_type[static_cast<std::size_t>(TokenType::END_OF_FILE) + 1] = {};
+    };
 
-    const std::vector<Token>& lex();
-    const std::vector<Token>& get_tokens() const { return tokens; }
+    // the lexer doesn't copy the source, it has to outlive the lexer; identifiers are interned into names
+    Lexer(std::string_view file, Interner& names);
+    // for lexing a piece of a larger source: file runs up to the end of the piece, which starts at start.
+    // errors are located through lines, a table over (at least) file that may be shared between threads
+    Lexer(std::string_view file, Interner& names, std::size_t start, const LineTable& lines);
+
+    // pulls one token; at the end of the source that's END_OF_FILE, every time it's called
+    Token next();
+    // the whole source at once, on top of next()
+    const TokenBuffer& lex();
+    const TokenBuffer& get_tokens() const { return tokens; }
+    const LineTable& get_lines() const { return *lines; }
+
+    // true once an error was reported
+    bool failed() const { return errors != 0; }
+    // true if the source ended inside a string or character literal (which a longer source might close)
+    bool open_at_end() const { return open_literal; }
+    const Counters& get_counters() const { return counters; }
 private:
+    void emit(TokenType type, std::string_view value, Symbol symbol = Symbol::NONE)
+    {
+        current = Token{type, value, SourceLocation{static_cast<std::uint32_t>(token_start)}, symbol};
+        produced = true;
+    }
+    // punctuators and keywords, spelled from the table
+    void add(TokenType type) { emit(type, token_spelling(type)); }
+    // where the current token starts, for errors
+    LineColumn where() const { return lines->lookup(SourceLocation{static_cast<std::uint32_t>(token_start)}); }
+    void error(const std::string& what);
+    void operator_token(char ch, const CharInfo& info);
     bool check(char c);
     const char consume(); 
 
-    void keyword(char seed); 
+    void keyword(); 
     void string();
     void _char();  
-    void number(char c);
+    void number();
 private:
-    std::string file; 
-    std::vector<Token> tokens;
-    std::size_t curr_char; 
-    std::size_t line = 1; 
-
-    inline static const std::unordered_map<std::string, TokenType> keyword_to_token_type = {
-        {"if",       TokenType::IF},
-        {"else",     TokenType::ELSE},
-        {"while",    TokenType::WHILE},
-        {"for",      TokenType::FOR},
-        {"return",   TokenType::RETURN},
-        {"int",      TokenType::INT},
-        {"char",     TokenType::CHAR},
-        {"void",     TokenType::VOID},
-        {"struct",   TokenType::STRUCT},
-        {"break",    TokenType::BREAK},
-        {"continue", TokenType::CONTINUE}
-    };
+    std::string_view file; 
+    Interner& names;
+    TokenBuffer tokens;
+    const LineTable* lines;
+    std::size_t curr_char = 0; 
+    std::size_t token_start = 0;
+    // the token next() is about to return
+    Token current;
+    bool produced = false;
+    std::size_t errors = 0;
+    bool open_literal = false;
+    Counters counters;
 };
 
 #endif
\ No newline at end of file
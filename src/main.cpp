@@ -1,63 +1,346 @@
-#include <iostream> 
+#include <iostream>
+#include "ast_cache.h"
 #include "error.h"
 #include "lexer.h"
+#include "parallel_lexer.h"
+#include "parallel_parser.h"
 #include "parser.h"
-#include <fstream> 
-#include <sstream>
+#include <optional>
+#include <string>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
 #include "compiler.h"
 #include "semanalyzer.h"
+#include "phases.h"
+#include "stats.h"
+#include "remarks.h"
+#include "llvm/Support/MemoryBuffer.h"
 
-int main(int argc, char* argv[]) 
+static const char* usage =
+    "Usage: mini-c [-O0|-O1|-O2|-O3] [-Rpass=<regex>] [-Rpass-missed=<regex>] [-Rpass-analysis=<regex>]\n"
+    "              [--remarks-yaml=<file>] [--time-report] [--mem-report] [--time-trace[=<file>]]\n"
+    "              [--time-trace-granularity=<us>] [--stats] [--stats-json=<file>] [--lex-threads=<n>]\n"
+    "              [--parse-threads=<n>] [--ast-cache=<dir>]\n"
+    "              <source-file | ->\n";
+
+// the value of a numeric flag (thread counts, the trace granularity), nothing if it isn't a plain decimal number
+static std::optional<unsigned> parse_unsigned(const char* text)
 {
-    if (argc < 2)
+    if (*text < '0' || *text > '9')
     {
-        std::cerr << "Usage: mini-c <source-file>\n";
-        return 1;
+        return std::nullopt; // strtoul would skip spaces and take a sign
     }
 
-    const char* filename = argv[1];
-    std::fstream file(filename);
-    if (!file.is_open())
+    char* end = nullptr;
+    errno = 0;
+    const auto value = std::strtoul(text, &end, 10);
+    if (*end != '\0' || errno == ERANGE || value > UINT_MAX)
     {
-        report_err(std::cout, "mini-c couldn't open translation unit for compilation!");
-        return 1;
+        return std::nullopt;
     }
-    
-    std::string file_contents = (std::ostringstream() << file.rdbuf()).str();
+    return static_cast<unsigned>(value);
+}
 
-    Lexer lexer(file_contents); 
-    auto toks = lexer.lex();
+int main(int argc, char* argv[])
+{
+    const char* filename = nullptr;
+    PhaseTracker::Options phase_options;
+    bool time_trace = false;
+    bool print_stats = false;
+    std::string stats_json_path;
+    Codegen::Options codegen_options;
+    Remarks::Options remark_options;
+    // 1 streams tokens into the parser, anything else lexes the whole file up front on that many threads
+    // (0 = all of them)
+    unsigned lex_threads = 1;
+    // 1 parses the functions one after another, anything else on that many threads (0 = all of them), which
+    // needs the tokens up front
+    unsigned parse_threads = 1;
+    // where analyzed ASTs are kept between runs, empty = not at all
+    std::string cache_dir;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--time-report")
+        {
+            phase_options.time_report = true;
+        }
+        else if (arg == "--mem-report")
+        {
+            phase_options.mem_report = true;
+        }
+        else if (arg == "--time-trace" || arg.starts_with("--time-trace="))
+        {
+            // an empty path means "next to the source", filled in below
+            phase_options.time_trace_path = arg == "--time-trace" ? "" : arg.substr(std::strlen("--time-trace="));
+            time_trace = true;
+        }
+        else if (arg == "--stats")
+        {
+            print_stats = true;
+        }
+        else if (arg.starts_with("--stats-json="))
+        {
+            stats_json_path = arg.substr(std::strlen("--stats-json="));
+        }
+        else if (arg.starts_with("--time-trace-granularity="))
+        {
+            const auto granularity = parse_unsigned(argv[i] + std::strlen("--time-trace-granularity="));
+            if (!granularity)
+            {
+                std::cerr << usage;
+                return 1;
+            }
+            phase_options.time_trace_granularity = *granularity;
+        }
+        else if (arg.size() == 3 && arg.starts_with("-O") && arg[2] >= '0' && arg[2] <= '3')
+        {
+            codegen_options.opt_level = arg[2] - '0';
+        }
+        else if (arg.starts_with("-Rpass="))
+        {
+            remark_options.passed = arg.substr(std::strlen("-Rpass="));
+        }
+        else if (arg.starts_with("-Rpass-missed="))
+        {
+            remark_options.missed = arg.substr(std::strlen("-Rpass-missed="));
+        }
+        else if (arg.starts_with("-Rpass-analysis="))
+        {
+            remark_options.analysis = arg.substr(std::strlen("-Rpass-analysis="));
+        }
+        else if (arg.starts_with("--remarks-yaml="))
+        {
+            remark_options.yaml_path = arg.substr(std::strlen("--remarks-yaml="));
+        }
+        else if (arg.starts_with("--lex-threads="))
+        {
+            const auto threads = parse_unsigned(argv[i] + std::strlen("--lex-threads="));
+            if (!threads)
+            {
+                std::cerr << usage;
+                return 1;
+            }
+            lex_threads = *threads;
+        }
+        else if (arg.starts_with("--parse-threads="))
+        {
+            const auto threads = parse_unsigned(argv[i] + std::strlen("--parse-threads="));
+            if (!threads)
+            {
+                std::cerr << usage;
+                return 1;
+            }
+            parse_threads = *threads;
+        }
+        else if (arg.starts_with("--ast-cache="))
+        {
+            cache_dir = arg.substr(std::strlen("--ast-cache="));
+        }
+        else if ((arg.starts_with("-") && arg != "-") || filename)
+        {
+            std::cerr << usage;
+            return 1;
+        }
+        else
+        {
+            filename = argv[i];
+        }
+    }
 
-    if (get_err() == ErrorMode::ERR)
+    if (!filename)
     {
-        std::cerr << "Failed to lex the input file!\n";
+        std::cerr << usage;
         return 1;
     }
 
-    Parser parser(lexer.get_tokens());
-    auto expr = parser.get_program();
+    if (time_trace && phase_options.time_trace_path.empty())
+    {
+        // a source from stdin has no name to go next to
+        phase_options.time_trace_path = std::string(filename) == "-" ? "stdin.json" : std::string(filename) + ".json";
+    }
 
-    if (get_err() == ErrorMode::ERR)
+    PhaseTracker phases(phase_options);
+    const bool collect_stats = print_stats || !stats_json_path.empty();
+    Statistics stats;
+    // mapped read-only (big files, small ones are just read) and lexed in place, the source is never copied
+    std::unique_ptr<llvm::MemoryBuffer> source;
     {
-        std::cerr << "Failed to parse the input file!\n";
-        return 1;
+        PhaseTracker::Scope phase(phases, "read", "File read");
+        auto file = llvm::MemoryBuffer::getFileOrSTDIN(filename, false, false);
+        if (!file)
+        {
+            report_err(std::cout, "mini-c couldn't open translation unit for compilation!");
+            return 1;
+        }
+
+        source = std::move(*file);
+        // tokens keep 32-bit offsets into the source
+        if (source->getBufferSize() > UINT32_MAX)
+        {
+            report_err(std::cout, "mini-c can't compile translation units over 4 GiB!");
+            return 1;
+        }
     }
 
-    SemanticAnalyzer analyzer;
-    for (auto& s : expr)
+    // by default the parser pulls tokens from the lexer as it needs them, so lexing is timed as part of
+    // parsing. identifiers are interned as they're lexed, every later phase works with the ids
+    Interner names;
+    const std::string_view text(source->getBufferStart(), source->getBufferSize());
+    Lexer lexer(text, names);
+    ParallelLexer parallel_lexer(text, names, ParallelLexer::Options{.threads = lex_threads});
+
+    // a source compiled before, unchanged, goes straight to codegen
+    std::optional<AstCache> cache;
+    Parser::Program expr;
+    bool cached = false;
+    if (!cache_dir.empty())
     {
-        auto [ok, _] = analyzer.perform_analysis(s);
-        s = std::move(_);
-        if (!ok) 
+        PhaseTracker::Scope phase(phases, "cache-load", "AstCache::load");
+        cache.emplace(cache_dir, text);
+        if (auto unit = cache->load(names))
         {
-            std::cout << "Compilation failed: Failed parsing!";
+            expr = std::move(*unit);
+            cached = true;
+        }
+    }
+
+    // the line table is only built if something needs a line: a diagnostic or debug locations
+    const auto& lines = cached || lex_threads == 1 ? lexer.get_lines() : parallel_lexer.get_tokens().get_lines();
+    if (cached)
+    {
+        if (collect_stats) stats.collect(expr);
+    }
+    else
+    {
+        // tokens lexed up front, if they aren't streamed
+        const TokenBuffer* tokens = nullptr;
+        if (lex_threads != 1)
+        {
+            PhaseTracker::Scope phase(phases, "lex", "ParallelLexer::lex");
+            tokens = &parallel_lexer.lex();
+        }
+        else if (parse_threads != 1)
+        {
+            PhaseTracker::Scope phase(phases, "lex", "Lexer::lex");
+            tokens = &lexer.lex();
+        }
+
+        if (parse_threads != 1)
+        {
+            PhaseTracker::Scope phase(phases, "parse", "ParallelParser::get_program");
+            expr = ParallelParser(*tokens, ParallelParser::Options{.threads = parse_threads}).get_program();
+        }
+        else
+        {
+            PhaseTracker::Scope phase(phases, "parse", tokens ? "Parser::get_program" : "Parser::get_program (streaming Lexer)");
+            expr = tokens ? Parser(*tokens).get_program() : Parser(lexer).get_program();
+        }
+
+        if (lex_threads == 1 ? lexer.failed() : parallel_lexer.failed())
+        {
+            std::cerr << "Failed to lex the input file!\n";
             return 1;
         }
+
+        if (get_err() == ErrorMode::ERR)
+        {
+            std::cerr << "Failed to parse the input file!\n";
+            return 1;
+        }
+
+        if (collect_stats)
+        {
+            stats.collect(lex_threads == 1 ? lexer.get_counters() : parallel_lexer.get_counters());
+            stats.collect(expr);
+        }
+
+        SemanticAnalyzer analyzer(expr.nodes, names, lines);
+        {
+            PhaseTracker::Scope phase(phases, "sema", "Semantic analysis (declarations)");
+            for (auto& s : expr)
+            {
+                auto [ok, _] = analyzer.perform_analysis(s);
+                s = std::move(_);
+                if (!ok)
+                {
+                    std::cout << "Compilation failed: Failed parsing!";
+                    return 1;
+                }
+            }
+        }
+
+        if (collect_stats) stats.collect(analyzer.get_counters());
+
+        if (cache)
+        {
+            PhaseTracker::Scope phase(phases, "cache-store", "AstCache::store");
+            cache->store(expr, names);
+        }
     }
 
     std::cout << "\n\n\033[1mGenerating LLVM IR....\033[0m\n\n";
-    Codegen gen;
-    gen.compile_translation_unit(expr);
+    // remarks are only useful if they can be traced back to a line
+    codegen_options.debug_locations = remark_options.enabled();
+    codegen_options.lines = &lines;
+    codegen_options.source_name = filename;
+    // declared before the codegen, so the yaml file outlives the context streaming into it
+    Remarks remarks;
+    Codegen gen(names, codegen_options);
+    if (remark_options.enabled() && !remarks.install(gen.get_context(), remark_options))
+    {
+        return 1;
+    }
+
+    {
+        PhaseTracker::Scope phase(phases, "codegen", "Codegen (IR generation)");
+        gen.generate_translation_unit(expr);
+    }
+
+    if (collect_stats) stats.collect(gen.get_module());
+    bool verified;
+    {
+        // check if its generating good IR
+        PhaseTracker::Scope phase(phases, "verify", "llvm::verifyModule");
+        verified = gen.verify();
+        if (!verified)
+        {
+            llvm::errs() << "Module verification failed! Please consider this a severe skill issue.\n";
+        }
+    }
+    if (verified && codegen_options.opt_level > 0)
+    {
+        // the passes assume valid ir, a broken module is printed as generated instead
+        PhaseTracker::Scope phase(phases, "opt", "Optimization (-O" + std::to_string(codegen_options.opt_level) + ")");
+        gen.optimize();
+    }
+    remarks.finish();
+    {
+        PhaseTracker::Scope phase(phases, "print", "IR printing");
+        gen.print(llvm::outs());
+        llvm::outs().flush();
+    }
+
+    phases.print_report(llvm::errs());
+    if (print_stats)
+    {
+        stats.print(llvm::errs());
+    }
+
+    if (!stats_json_path.empty())
+    {
+        std::error_code ec;
+        llvm::raw_fd_ostream json(stats_json_path, ec);
+        if (ec)
+        {
+            report_err(std::cout, "couldn't write statistics to " + stats_json_path + ": " + ec.message());
+            return 1;
+        }
+        stats.write_json(json);
+    }
 
-    return 0;
+    return phases.write_time_trace() ? 0 : 1;
 }
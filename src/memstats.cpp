@@ -0,0 +1,137 @@
+#include "memstats.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+static std::atomic<bool> counting_enabled = false;
+static std::atomic<std::uint64_t> allocation_count = 0;
+static std::atomic<std::uint64_t> allocated_bytes = 0;
+
+void set_allocation_counting(const bool enabled)
+{
+    counting_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+AllocationCounters get_allocation_counters()
+{
+    return {
+        allocation_count.load(std::memory_order_relaxed),
+        allocated_bytes.load(std::memory_order_relaxed),
+    };
+}
+
+std::size_t get_peak_rss()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<std::size_t>(usage.ru_maxrss); // already bytes
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024; // kilobytes
+#endif
+#else
+    return 0;
+#endif
+}
+
+static void count_allocation(const std::size_t size)
+{
+    if (counting_enabled.load(std::memory_order_relaxed))
+    {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+static void* allocate(std::size_t size)
+{
+    count_allocation(size);
+    if (size == 0) size = 1;
+
+    while (true)
+    {
+        if (void* p = std::malloc(size)) return p;
+
+        // same retry loop as the default operator new
+        if (auto handler = std::get_new_handler())
+        {
+            handler();
+        }
+        else
+        {
+            throw std::bad_alloc();
+        }
+    }
+}
+
+static void* allocate_aligned(std::size_t size, std::align_val_t alignment)
+{
+    count_allocation(size);
+    const auto align = static_cast<std::size_t>(alignment);
+    // aligned_alloc wants the size to be a multiple of the alignment
+    size = (size + align - 1) / align * align;
+    if (size == 0) size = align;
+
+    while (true)
+    {
+        if (void* p = std::aligned_alloc(align, size)) return p;
+
+        if (auto handler = std::get_new_handler())
+        {
+            handler();
+        }
+        else
+        {
+            throw std::bad_alloc();
+        }
+    }
+}
+
+/* GLOBAL OPERATOR NEW/DELETE REPLACEMENTS */
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t a) { return allocate_aligned(size, a); }
+void* operator new[](std::size_t size, std::align_val_t a) { return allocate_aligned(size, a); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+
+void* operator new(std::size_t size, std::align_val_t a, const std::nothrow_t&) noexcept
+{
+    try { return allocate_aligned(size, a); } catch (...) { return nullptr; }
+}
+
+void* operator new[](std::size_t size, std::align_val_t a, const std::nothrow_t&) noexcept
+{
+    try { return allocate_aligned(size, a); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
@@ -0,0 +1,21 @@
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// process-wide allocation accounting through a replaced global operator new (see memstats.cpp)
+struct AllocationCounters
+{
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+};
+
+// counting is off by default, so the hook costs one relaxed load per allocation
+void set_allocation_counting(bool enabled);
+AllocationCounters get_allocation_counters();
+
+// high-water mark of the resident set size so far, in bytes (0 where unsupported)
+std::size_t get_peak_rss();
+
+#endif // MEMSTATS_H
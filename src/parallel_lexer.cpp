@@ -0,0 +1,129 @@
+#include "parallel_lexer.h"
+#include "chunking.h"
+#include "error.h"
+#include "scan.h"
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/ThreadPool.h"
+
+namespace
+{
+    // a piece of the source, lexed on its own
+    struct Chunk
+    {
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        std::optional<Interner> names;
+        std::optional<Lexer> lexer;
+        // its errors, reported once the chunks before it have been
+        std::vector<std::string> messages;
+    };
+
+    // lines is shared by all the chunks, so an error in any of them only builds it once
+    void lex_chunk(std::string_view file, const LineTable& lines, Chunk& chunk)
+    {
+        chunk.names.emplace();
+        chunk.lexer.emplace(file.substr(0, chunk.end), *chunk.names, chunk.begin, lines);
+        ErrorCapture capture;
+        chunk.lexer->lex();
+        chunk.messages = capture.get_messages();
+    }
+
+    void release(Chunk& chunk)
+    {
+        chunk.lexer.reset(); // before the interner it refers to
+        chunk.names.reset();
+        chunk.messages.clear();
+    }
+
+    // the chunk boundaries, each just past a newline so no token but a string or character literal can
+    // straddle one (comments end at the newline and everything else stops at whitespace)
+    std::vector<std::size_t> split(std::string_view file, std::size_t count)
+    {
+        std::vector<std::size_t> bounds{0};
+        for (std::size_t i = 1; i < count && bounds.back() < file.size(); ++i)
+        {
+            const auto from = std::max(bounds.back(), file.size() / count * i);
+            bounds.push_back(std::min(scan::find(file, from, '\n') + 1, file.size()));
+        }
+        if (bounds.size() == 1 || bounds.back() < file.size())
+        {
+            bounds.push_back(file.size()); // an empty source is still one (empty) chunk
+        }
+        return bounds;
+    }
+}
+
+ParallelLexer::ParallelLexer(std::string_view file, Interner& names, const Options& options)
+    : file(file), names(names), options(options), tokens(file, names)
+{
+}
+
+const TokenBuffer& ParallelLexer::lex()
+{
+    const auto strategy = llvm::hardware_concurrency(options.threads);
+    const auto threads = strategy.compute_thread_count();
+    const auto wanted = chunk_count_for(file.size(), options.min_chunk, threads);
+    const auto bounds = split(file, wanted);
+    // sized once, the lexers hold on to their chunk's interner
+    std::vector<Chunk> chunks(bounds.size() - 1);
+    chunk_count = chunks.size();
+
+    llvm::ThreadPool pool(strategy);
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+    {
+        chunks[i].begin = bounds[i];
+        chunks[i].end = bounds[i + 1];
+        pool.async([&, i] { lex_chunk(file, tokens.get_lines(), chunks[i]); });
+    }
+    pool.wait();
+
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+    {
+        // a literal left open at the end of a chunk might be closed in the next one, lex both again as one
+        // piece. that's rare and the pieces are small, so it's done here, on one thread
+        while (chunks[i].lexer->open_at_end() && i + 1 < chunks.size())
+        {
+            chunks[i + 1].begin = chunks[i].begin;
+            release(chunks[i]);
+            lex_chunk(file, tokens.get_lines(), chunks[++i]);
+        }
+        auto& chunk = chunks[i];
+
+        // the chunk's symbols in the order it saw them become ours in that order, as lexing in one go would
+        std::vector<Symbol> symbols(chunk.names->size());
+        for (std::size_t s = 0; s < symbols.size(); ++s)
+        {
+            symbols[s] = names.intern(chunk.names->spelling(static_cast<Symbol>(s)));
+        }
+        tokens.append(chunk.lexer->get_tokens(), symbols);
+
+        for (const auto& what : chunk.messages)
+        {
+            report_err(std::cout, what);
+        }
+        errors += chunk.messages.size();
+
+        const auto& chunk_counters = chunk.lexer->get_counters();
+        for (std::size_t t = 0; t < std::size(counters.by_type); ++t)
+        {
+            counters.by_type[t] += chunk_counters.by_type[t];
+        }
+        --counters.by_type[static_cast<std::size_t>(TokenType::END_OF_FILE)];
+
+        if (i + 1 == chunks.size())
+        {
+            tokens.push(Token{TokenType::END_OF_FILE, "", SourceLocation{static_cast<std::uint32_t>(file.size())}});
+            ++counters.by_type[static_cast<std::size_t>(TokenType::END_OF_FILE)];
+        }
+        // done with it, don't hold on to two copies of the tokens
+        release(chunk);
+    }
+
+    return tokens;
+}
@@ -0,0 +1,44 @@
+#ifndef PARALLEL_LEXER_H
+#define PARALLEL_LEXER_H
+
+#include <string_view>
+#include "interner.h"
+#include "lexer.h"
+#include "token_buffer.h"
+
+// Lexer::lex() on several threads, for sources of hundreds of MB. the source is cut into chunks just after
+// newlines, the chunks are lexed on a thread pool (each with its own interner, their errors held back) and
+// then stitched together in order, so the tokens, symbols and errors come out as if lexed in one go.
+class ParallelLexer
+{
+public:
+    struct Options
+    {
+        // 0 = one per hardware thread
+        unsigned threads = 0;
+        // sources aren't cut into chunks smaller than this, small ones aren't worth the threads
+        std::size_t min_chunk = 1 << 20;
+    };
+
+    // like Lexer, the source has to outlive the lexer and identifiers are interned into names
+    ParallelLexer(std::string_view file, Interner& names) : ParallelLexer(file, names, Options()) {}
+    ParallelLexer(std::string_view file, Interner& names, const Options& options);
+
+    const TokenBuffer& lex();
+    const TokenBuffer& get_tokens() const { return tokens; }
+
+    bool failed() const { return errors != 0; }
+    const Lexer::Counters& get_counters() const { return counters; }
+    // how many chunks the last lex() cut the source into
+    std::size_t get_chunk_count() const { return chunk_count; }
+private:
+    std::string_view file;
+    Interner& names;
+    Options options;
+    TokenBuffer tokens;
+    std::size_t errors = 0;
+    std::size_t chunk_count = 0;
+    Lexer::Counters counters;
+};
+
+#endif // PARALLEL_LEXER_H
@@ -0,0 +1,116 @@
+#include "parallel_parser.h"
+#include "chunking.h"
+#include "error.h"
+#include <algorithm>
+#include <vector>
+
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/ThreadPool.h"
+
+namespace
+{
+    // a run of whole top-level functions, parsed on its own
+    struct Chunk
+    {
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        Parser::Program program;
+        bool failed = false;
+    };
+
+    void parse_chunk(const TokenBuffer& tokens, Chunk& chunk)
+    {
+        // held back: if it failed, it's parsed again by the serial parser, which reports for real
+        ErrorCapture capture;
+        chunk.program = Parser(tokens, chunk.begin, chunk.end).get_program();
+        chunk.failed = capture.failed();
+    }
+
+    // one past the closing brace of every top-level function, by brace depth over the token kinds alone
+    std::vector<std::size_t> function_ends(const TokenBuffer& tokens)
+    {
+        std::vector<std::size_t> ends;
+        std::size_t depth = 0;
+        const auto size = tokens.size() - 1; // the END_OF_FILE can't end anything
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            switch (tokens.kind(i))
+            {
+            case TokenType::LEFT_BRACE:
+                ++depth;
+                break;
+            case TokenType::RIGHT_BRACE:
+                // a stray } stays at the top level, the parser will complain about it
+                if (depth > 0 && --depth == 0)
+                {
+                    ends.push_back(i + 1);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        return ends;
+    }
+
+    // the chunk boundaries, each at a function end, about evenly apart in tokens
+    std::vector<std::size_t> split(const std::vector<std::size_t>& ends, std::size_t size, std::size_t count)
+    {
+        std::vector<std::size_t> bounds{0};
+        for (std::size_t i = 1; i < count; ++i)
+        {
+            const auto at = std::lower_bound(ends.begin(), ends.end(), std::max(size / count * i, bounds.back() + 1));
+            if (at == ends.end())
+            {
+                break;
+            }
+            bounds.push_back(*at);
+        }
+        if (bounds.size() == 1 || bounds.back() < size)
+        {
+            bounds.push_back(size); // whatever follows the last function goes with it
+        }
+        return bounds;
+    }
+}
+
+Parser::Program ParallelParser::get_program()
+{
+    const auto strategy = llvm::hardware_concurrency(options.threads);
+    const auto threads = strategy.compute_thread_count();
+    const auto size = tokens.size() - 1;
+    const auto wanted = chunk_count_for(size, options.min_chunk, threads);
+    if (wanted == 1)
+    {
+        chunk_count = 1;
+        return Parser(tokens).get_program();
+    }
+
+    const auto bounds = split(function_ends(tokens), size, wanted);
+    std::vector<Chunk> chunks(bounds.size() - 1);
+    chunk_count = chunks.size();
+
+    llvm::ThreadPool pool(strategy);
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+    {
+        chunks[i].begin = bounds[i];
+        chunks[i].end = bounds[i + 1];
+        pool.async([&, i] { parse_chunk(tokens, chunks[i]); });
+    }
+    pool.wait();
+
+    Parser::Program program;
+    for (auto& chunk : chunks)
+    {
+        if (chunk.failed)
+        {
+            // the serial parser stops at its first broken function, with whatever it had parsed of it. the chunks
+            // before this one are what it would have parsed up to here, the rest is left to it
+            program.append(Parser(tokens, chunk.begin, size).get_program());
+            break;
+        }
+        program.append(std::move(chunk.program)); // which leaves the chunk's nodes empty
+    }
+
+    return program;
+}
@@ -0,0 +1,37 @@
+#ifndef PARALLEL_PARSER_H
+#define PARALLEL_PARSER_H
+
+#include "parser.h"
+#include "token_buffer.h"
+
+// Parser::get_program() on several threads, for files with thousands of functions. the top-level functions are
+// found by matching braces over the token kinds, runs of them are parsed on a thread pool (each into its own
+// nodes, their errors held back) and the pieces are joined in order, so the program comes out as if parsed in
+// one go. a piece that doesn't parse cleanly is parsed again from its start to the end of the file on one
+// thread, for the exact errors (and the exact partial program) the serial parser would have given
+class ParallelParser
+{
+public:
+    struct Options
+    {
+        // 0 = one per hardware thread
+        unsigned threads = 0;
+        // pieces get at least this many tokens, small files aren't worth the threads
+        std::size_t min_chunk = 1 << 16;
+    };
+
+    // the tokens have to end in END_OF_FILE, as Lexer::lex() leaves them, and outlive the parser
+    explicit ParallelParser(const TokenBuffer& tokens) : ParallelParser(tokens, Options()) {}
+    ParallelParser(const TokenBuffer& tokens, const Options& options) : tokens(tokens), options(options) {}
+
+    Parser::Program get_program();
+
+    // how many pieces the last get_program() cut the tokens into
+    std::size_t get_chunk_count() const { return chunk_count; }
+private:
+    const TokenBuffer& tokens;
+    Options options;
+    std::size_t chunk_count = 0;
+};
+
+#endif // PARALLEL_PARSER_H
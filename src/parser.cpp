@@ -1,8 +1,46 @@
 #include "parser.h"
+#include <array>
+#include <charconv>
 #include <iostream>
 #include <string>
 #include <sstream>
 #include "error.h"
+#include "stack.h"
+
+namespace
+{
+    // how tightly an infix operator holds on to its operands, from assignment (loosest) to multiplication
+    enum Precedence : std::uint8_t
+    {
+        NOT_INFIX, ASSIGNMENT, LOGIC_OR, LOGIC_AND, EQUALITY, RELATIONAL, ADDITIVE, MULTIPLICATIVE
+    };
+
+    struct BindingPower
+    {
+        std::uint8_t power = NOT_INFIX;
+        bool right = false; // right associative
+    };
+
+    // indexed by token type, NOT_INFIX for tokens that don't continue an expression
+    constexpr auto binding_powers = []
+    {
+        std::array<BindingPower, static_cast<std::size_t>(TokenType::END_OF_FILE) + 1> table{};
+        const auto set = [&](std::initializer_list<TokenType> ops, Precedence power, bool right = false)
+        {
+            for (const auto op : ops) table[static_cast<std::size_t>(op)] = {power, right};
+        };
+
+        set({TokenType::EQUAL, TokenType::PLUS_EQUAL, TokenType::MINUS_EQUAL, TokenType::STAR_EQUAL,
+             TokenType::SLASH_EQUAL, TokenType::PERCENT_EQUAL}, ASSIGNMENT, true);
+        set({TokenType::OR}, LOGIC_OR);
+        set({TokenType::AND}, LOGIC_AND);
+        set({TokenType::EQUAL_EQUAL, TokenType::BANG_EQUAL}, EQUALITY);
+        set({TokenType::LESS, TokenType::LESS_EQUAL, TokenType::GREATER, TokenType::GREATER_EQUAL}, RELATIONAL);
+        set({TokenType::PLUS, TokenType::MINUS}, ADDITIVE);
+        set({TokenType::STAR, TokenType::SLASH, TokenType::PERCENT}, MULTIPLICATIVE);
+        return table;
+    }();
+}
 
 void TreePrinter::indent()
 {
@@ -12,8 +50,9 @@ void TreePrinter::indent()
     }
 }
 
-void TreePrinter::operator()(std::unique_ptr<AST::Binary>& bin)
+void TreePrinter::operator()(AST::Ref<AST::Binary> ref)
 {
+    const auto* bin = &nodes[ref];
     indent(); std::cout << "BinaryExpression: op = " << static_cast<int>(bin->op) << "\n";
     indent_level++;
     indent(); std::cout << "Left:\n";
@@ -26,8 +65,9 @@ void TreePrinter::operator()(std::unique_ptr<AST::Binary>& bin)
     indent_level -= 2;
 }
 
-void TreePrinter::operator()(std::unique_ptr<AST::Unary>& unary)
+void TreePrinter::operator()(AST::Ref<AST::Unary> ref)
 {
+    const auto* unary = &nodes[ref];
     indent(); std::cout << "UnaryExpression: op = " << static_cast<int>(unary->op) << "\n";
     indent_level++;
     indent(); std::cout << "Operand:\n";
@@ -36,8 +76,9 @@ void TreePrinter::operator()(std::unique_ptr<AST::Unary>& unary)
     indent_level -= 2;
 }
 
-void TreePrinter::operator()(std::unique_ptr<AST::Assignment>& assign)
+void TreePrinter::operator()(AST::Ref<AST::Assignment> ref)
 {
+    const auto* assign = &nodes[ref];
     indent(); std::cout << "Assignment: op = " << static_cast<int>(assign->op) << "\n";
     indent_level++;
     indent(); std::cout << "LHS:\n";
@@ -50,26 +91,29 @@ void TreePrinter::operator()(std::unique_ptr<AST::Assignment>& assign)
     indent_level -= 2;
 }
 
-void TreePrinter::operator()(std::unique_ptr<AST::Call>& call)
+void TreePrinter::operator()(AST::Ref<AST::Call> ref)
 {
-    indent(); std::cout << "FunctionCall: " << call->func_name.value << "\n";
+    const auto* call = &nodes[ref];
+    indent(); std::cout << "FunctionCall: " << names.spelling(call->func_name) << "\n";
     indent_level++;
     indent(); std::cout << "Arguments:\n";
     indent_level++;
-    for (auto& arg : call->args)
+    for (const auto& arg : nodes[call->args])
     {
         std::visit(*this, arg);
     }
     indent_level -= 2;
 }
 
-void TreePrinter::operator()(const AST::Variable& var)
+void TreePrinter::operator()(AST::Ref<AST::Variable> ref)
 {
-    indent(); std::cout << "Variable: " << var.name.value << "\n";
+    const auto& var = nodes[ref];
+    indent(); std::cout << "Variable: " << names.spelling(var.name) << "\n";
 }
 
-void TreePrinter::operator()(std::unique_ptr<AST::StructAccess>& sa)
+void TreePrinter::operator()(AST::Ref<AST::StructAccess> ref)
 {
+    const auto* sa = &nodes[ref];
     indent(); std::cout << "StructAccess: ." << sa->member_name << "\n";
     indent_level++;
     indent(); std::cout << "Object:\n";
@@ -78,8 +122,9 @@ void TreePrinter::operator()(std::unique_ptr<AST::StructAccess>& sa)
     indent_level -= 2;
 }
 
-void TreePrinter::operator()(std::unique_ptr<AST::ArrayAccess>& aa)
+void TreePrinter::operator()(AST::Ref<AST::ArrayAccess> ref)
 {
+    const auto* aa = &nodes[ref];
     indent(); std::cout << "ArrayAccess:\n";
     indent_level++;
     indent(); std::cout << "Array:\n";
@@ -92,28 +137,51 @@ void TreePrinter::operator()(std::unique_ptr<AST::ArrayAccess>& aa)
     indent_level -= 2;
 }
 
+void NodeCounter::count(const AST::TranslationUnit& program)
+{
+    const auto& nodes = program.nodes;
+    auto count_kinds = [&]<typename... Refs>(std::size_t* counts, std::type_identity<std::variant<Refs...>>)
+    {
+        ((*counts++ += nodes.count<typename Refs::element_type>()), ...);
+    };
+    count_kinds(expressions, std::type_identity<AST::ExprVariant>{});
+    count_kinds(statements, std::type_identity<AST::StatementVariant>{});
+    count_kinds(declarations, std::type_identity<AST::DeclarationVariant>{});
+}
+
+std::size_t NodeCounter::total() const
+{
+    std::size_t sum = 0;
+    for (auto n : expressions) sum += n;
+    for (auto n : statements) sum += n;
+    for (auto n : declarations) sum += n;
+    return sum;
+}
+
 Parser::Program Parser::get_program()
 {
     auto p = Program{};
-    while (current_tok < tokens.size() - 1)
+    nodes = &p.nodes;
+    while (!check(TokenType::END_OF_FILE))
     {
-        p.push_back(parse_function_declaration());
+        p.declarations.push_back(parse_function_declaration());
         if (is_panic)
         {
             // just stop parsing, and keep life simple; this is not production code anyway
             break;
         }
     }
+    nodes = nullptr;
     return p;
 }
 
 AST::DeclarationVariant Parser::parse_function_declaration()
 {
     // get the main header info
-    auto return_type_token = advance(); 
-    auto line = return_type_token.line; 
-    auto return_ty = return_type_token.value;
-    auto name_token = expect(TokenType::IDENTIFIER, "Expected function name after return type in function declaration.").value;
+    const auto return_type_token = advance(); 
+    auto location = return_type_token.location; 
+    const auto return_ty = AST::type_from_token(return_type_token.type);
+    const auto name_token = expect(TokenType::IDENTIFIER, "Expected function name after return type in function declaration.").symbol;
     expect(TokenType::LEFT_PAREN, "Expected ( after function name in function declaration.");
     // parse arguments
     std::vector<AST::FunctionDeclaration::FunctionArg> params;
@@ -122,14 +190,13 @@ AST::DeclarationVariant Parser::parse_function_declaration()
         // get the arg first, then loop back for the next one if possible
         do 
         {
-            auto type_token = advance(); 
-            auto type = type_token.value; 
+            const auto type_token = advance(); 
             if (type_token.type == TokenType::STRUCT)
             {
-                type = expect(TokenType::IDENTIFIER, "Expected struct name after 'struct' keyword in function argument.").value;
+                expect(TokenType::IDENTIFIER, "Expected struct name after 'struct' keyword in function argument.");
             }
-            auto name = expect(TokenType::IDENTIFIER, "Expected argument name after type in function argument.").value;
-            params.emplace_back(type, name);
+            const auto name = expect(TokenType::IDENTIFIER, "Expected argument name after type in function argument.").symbol;
+            params.emplace_back(AST::type_from_token(type_token.type), name);
         } 
         while (check(TokenType::COMMA) && advance().type == TokenType::COMMA);
     }
@@ -138,14 +205,14 @@ AST::DeclarationVariant Parser::parse_function_declaration()
     // get the body
     auto body_variant = parse_block_statement();
     // Extract BlockStatement from variant
-    auto body_ptr = std::move(std::get<std::unique_ptr<AST::BlockStatement>>(body_variant));
-    return std::make_unique<AST::FunctionDeclaration>(line, name_token, return_ty, params, std::move(body_ptr));
+    const auto body = std::get<AST::Ref<AST::BlockStatement>>(body_variant);
+    return nodes->make<AST::FunctionDeclaration>(location, name_token, return_ty, nodes->make_list(params), body);
 }
 
 AST::StatementVariant Parser::parse_block_statement()
 {
     auto statements = std::vector<AST::StatementVariant>{};
-    std::size_t line = advance().line; // advance past the {
+    const auto location = advance().location; // advance past the {
 
     statements.reserve(20);
     while (peek().type != TokenType::RIGHT_BRACE && !is_panic)
@@ -155,25 +222,25 @@ AST::StatementVariant Parser::parse_block_statement()
 
     if (!is_panic) expect(TokenType::RIGHT_BRACE, "Expected } to close off block statement");
 
-    return std::make_unique<AST::BlockStatement>(line, statements);
+    return nodes->make<AST::BlockStatement>(location, nodes->make_list(statements));
 }
 
 AST::StatementVariant Parser::parse_return_statement()
 {
-    auto line = expect(TokenType::RETURN, "Expected return keyword for return statement!").line;
+    auto location = expect(TokenType::RETURN, "Expected return keyword for return statement!").location;
     // handle void returns
     if (peek().type == TokenType::SEMICOLON)
     {
         advance(); // get rid of the semicolon
-        return std::make_unique<AST::ReturnStatement>(line, std::nullopt);
+        return nodes->make<AST::ReturnStatement>(location, std::nullopt);
     }
 
     auto expr = parse_assignment();
     expect(TokenType::SEMICOLON, "Expected ; after return expression!");
-    return std::make_unique<AST::ReturnStatement>(line, std::make_optional(std::move(expr)));
+    return nodes->make<AST::ReturnStatement>(location, std::make_optional(expr));
 }
 
-const Token& Parser::expect(const TokenType t, const std::string& error)
+Token Parser::expect(const TokenType t, const std::string& error)
 {
     if (!check(t))
     {
@@ -195,8 +262,7 @@ bool Parser::is_type(const Token& tok)
     // must have a ident after the struct keyword
     case TokenType::STRUCT:
         // look 2 ahead lol
-        if (current_tok + 1 >= tokens.size()) return false;
-        return tokens[current_tok + 1].type == TokenType::IDENTIFIER;
+        return tokens.peek(1).type == TokenType::IDENTIFIER;
     default:
         return false;
     }
@@ -204,71 +270,74 @@ bool Parser::is_type(const Token& tok)
 
 AST::StatementVariant Parser::parse_statement()
 {
-    if (is_type(peek()))
-    {
-        return parse_variable_declaration();
-    }
-    else if (peek().type == TokenType::IDENTIFIER && peek().value != "printf")
-    {
-        return parse_expression_statement();
-    }
-    else if (peek().type == TokenType::IF)
-    {
-        return parse_if_else_statement();
-    }
-    else if (peek().type == TokenType::WHILE)
+    // statements nest (blocks, if and while bodies), see stack.h
+    return run_with_stack([&]
     {
-        return parse_while_statement();
-    }
-    else if (peek().type == TokenType::LEFT_BRACE)
-    {
-        return parse_block_statement();
-    }
-    else if (peek().type == TokenType::RETURN)
-    {
-        return parse_return_statement();
-    }
+        if (is_type(peek()))
+        {
+            return parse_variable_declaration();
+        }
+        else if (peek().type == TokenType::IDENTIFIER && peek().symbol != Symbol::PRINTF)
+        {
+            return parse_expression_statement();
+        }
+        else if (peek().type == TokenType::IF)
+        {
+            return parse_if_else_statement();
+        }
+        else if (peek().type == TokenType::WHILE)
+        {
+            return parse_while_statement();
+        }
+        else if (peek().type == TokenType::LEFT_BRACE)
+        {
+            return parse_block_statement();
+        }
+        else if (peek().type == TokenType::RETURN)
+        {
+            return parse_return_statement();
+        }
 
-    return parse_printf();
+        return parse_printf();
+    });
 }
 
 AST::StatementVariant Parser::parse_printf()
 {
-    std::size_t line = advance().line; // printf
+    const auto location = advance().location; // printf
     expect(TokenType::LEFT_PAREN, "Expected '(' after printf");
     auto expr = parse_assignment();
     expect(TokenType::RIGHT_PAREN, "Expected ')' after printf.");
     expect(TokenType::SEMICOLON, "Expected ';' after printf.");
-    auto print = std::make_unique<AST::PrintStatement>(line, std::move(expr));
+    auto print = nodes->make<AST::PrintStatement>(location, expr);
     return print;
 }
 
 AST::StatementVariant Parser::parse_variable_declaration()
 {
     const auto identifier = advance();
-    auto type = identifier.value;
-    // make sure to get the actual typename from the second one
+    // structs aren't analyzed yet, their name is skipped and the type left UNKNOWN
     if (identifier.type == TokenType::STRUCT)
     {
-        type = expect(TokenType::IDENTIFIER, "Expected an identifier after 'struct.'").value;
+        expect(TokenType::IDENTIFIER, "Expected an identifier after 'struct.'");
     }
-    auto name = expect(TokenType::IDENTIFIER, "Expected a variable name.").value;
+    const auto name = expect(TokenType::IDENTIFIER, "Expected a variable name.").symbol;
     expect(TokenType::EQUAL, "Expected '=' for assignment.");
     auto value = parse_assignment(); // top level expression from C standard
     expect(TokenType::SEMICOLON, "Expected ';' after assignment.");
-    return std::make_unique<AST::VariableDecl>(identifier.line, name, type, value);
+    return nodes->make<AST::VariableDecl>(identifier.location, name, AST::type_from_token(identifier.type), value);
 }
 
 AST::StatementVariant Parser::parse_expression_statement()
 {
     auto expr = parse_assignment(); // highest precedence
     expect(TokenType::SEMICOLON, "Expected ; after expression!");
-    return std::make_unique<AST::ExpressionStatement>(get_line(expr), expr);
+    return nodes->make<AST::ExpressionStatement>(get_location(expr), expr);
 }
 
 AST::StatementVariant Parser::parse_if_else_statement()
 {
-    auto line = expect(TokenType::IF, "Expected if for if statement!").line;
+    auto location = expect(TokenType::IF, "Expected if for if statement!").location;
     expect(TokenType::LEFT_PAREN, "Expected ( to start conditional in if statement!");
     // get the internal condition
     auto condition = parse_assignment();
@@ -277,23 +346,24 @@ AST::StatementVariant Parser::parse_if_else_statement()
     expect(TokenType::ELSE, "Expected else after if body."); // TODO: make this optional
     auto else_body = parse_statement();
 
-    return std::make_unique<AST::IfElseStatement>(line, condition, if_body, else_body);
+    return nodes->make<AST::IfElseStatement>(location, condition, if_body, else_body);
 }
 
 AST::StatementVariant Parser::parse_while_statement()
 {
-    auto line = expect(TokenType::WHILE, "Expected while for while statement!").line;
+    auto location = expect(TokenType::WHILE, "Expected while for while statement!").location;
     expect(TokenType::LEFT_PAREN, "Expected ( to start conditional in while statement!");
     // get the internal condition
     auto condition = parse_assignment();
     expect(TokenType::RIGHT_PAREN, "Expected )");
     auto body = parse_statement();
 
-    return std::make_unique<AST::WhileStatement>(line, condition, body);
+    return nodes->make<AST::WhileStatement>(location, condition, body);
 }
 
-void TreePrinter::operator()(const AST::Literal& lit)
+void TreePrinter::operator()(AST::Ref<AST::Literal> ref)
 {
+    const auto& lit = nodes[ref];
     indent();
     std::visit([](auto&& val) {
         std::cout << "Literal: " << val << "\n";
@@ -307,119 +377,40 @@ AST::ExprVariant Parser::get_program()
 }
 */
 
-AST::ExprVariant Parser::parse_assignment()
+AST::ExprVariant Parser::parse_expression(const std::uint8_t min_power)
 {
-    auto lhs = parse_logic_or();
+    auto lhs = parse_unary();
 
-    if (check(TokenType::EQUAL))
+    // fold in operators for as long as they bind tighter than the one waiting for this expression
+    for (auto binding = binding_powers[static_cast<std::size_t>(peek().type)]; binding.power > min_power;
+         binding = binding_powers[static_cast<std::size_t>(peek().type)])
     {
-        auto op = advance();
-        auto rhs = parse_assignment();  // recursive call for right-associativity
-        return std::make_unique<AST::Assignment>(get_line(lhs), std::move(lhs), op.type, std::move(rhs));
+        const auto op = advance().type;
+        // the rhs of a left associative operator stops at the next one of its level, a right associative one's
+        // takes it in
+        auto rhs = run_with_stack([&] { return parse_expression(binding.right ? binding.power - 1 : binding.power); });
+        if (binding.power == ASSIGNMENT)
+        {
+            lhs = nodes->make<AST::Assignment>(get_location(lhs), lhs, op, rhs);
+        }
+        else
+        {
+            lhs = nodes->make<AST::Binary>(get_location(lhs), lhs, op, rhs);
+        }
     }
 
     return lhs;
 }
 
-
-AST::ExprVariant Parser::parse_logic_or() 
-{
-    auto lhs = parse_logic_and(); 
-    while (check(TokenType::OR)) 
-    {
-        advance(); // get rid of ampersand
-        auto rhs = parse_logic_and(); 
-        lhs = std::make_unique<AST::Binary>(get_line(lhs), std::move(lhs), TokenType::OR, std::move(rhs)); 
-    }
-
-    return lhs; 
-}
-
-AST::ExprVariant Parser::parse_logic_and()
-{
-    auto lhs = parse_equality(); 
-    while (check(TokenType::OR)) 
-    {
-        advance(); // get rid of ampersand
-        auto rhs = parse_equality(); 
-        lhs = std::make_unique<AST::Binary>(get_line(lhs), std::move(lhs), TokenType::AND, std::move(rhs)); 
-    }
-
-    return lhs; 
-}
-
-AST::ExprVariant Parser::parse_equality()
-{
-    static TokenType equality_ops[] = {TokenType::EQUAL_EQUAL, TokenType::BANG_EQUAL};
-    
-    TokenType found_token;
-    auto lhs = parse_relational(); 
-    while (check(equality_ops, sizeof(equality_ops) / sizeof(TokenType), found_token)) 
-    {
-        advance(); // get rid of ampersand
-        auto rhs = parse_relational(); 
-        lhs = std::make_unique<AST::Binary>(get_line(lhs), std::move(lhs), found_token, std::move(rhs)); 
-    }
-
-    return lhs; 
-}
-
-AST::ExprVariant Parser::parse_relational()
-{
-    static TokenType relational_ops[] = {TokenType::LESS, TokenType::LESS_EQUAL, TokenType::GREATER, TokenType::GREATER_EQUAL};
-    
-    TokenType found_token;
-    auto lhs = parse_additive(); 
-    while (check(relational_ops, sizeof(relational_ops) / sizeof(TokenType), found_token)) 
-    {
-        advance(); // get rid of ampersand
-        auto rhs = parse_additive(); 
-        lhs = std::make_unique<AST::Binary>(get_line(lhs), std::move(lhs), found_token, std::move(rhs)); 
-    }
-
-    return lhs; 
-}
-
-AST::ExprVariant Parser::parse_additive()
-{
-    static TokenType additive_ops[] = {TokenType::PLUS, TokenType::MINUS}; 
-
-    TokenType found_token; 
-    auto lhs = parse_multiplicative(); 
-    while (check(additive_ops, sizeof(additive_ops) / sizeof(TokenType), found_token))
-    {
-        advance(); 
-        auto rhs = parse_multiplicative(); 
-        lhs = std::make_unique<AST::Binary>(get_line(lhs), std::move(lhs), found_token, std::move(rhs)); 
-    }
-
-    return lhs; 
-}
-
-AST::ExprVariant Parser::parse_multiplicative()
-{
-    static TokenType mul_ops[] = {TokenType::STAR, TokenType::SLASH}; 
-
-    TokenType found_token; 
-    auto lhs = parse_unary(); 
-    while (check(mul_ops, sizeof(mul_ops) / sizeof(TokenType), found_token))
-    {
-        advance(); 
-        auto rhs = parse_unary(); 
-        lhs = std::make_unique<AST::Binary>(get_line(lhs), std::move(lhs), found_token, std::move(rhs)); 
-    }
-
-    return lhs; 
-}
-
 AST::ExprVariant Parser::parse_unary()
 {
     static TokenType unary_ops[] = {TokenType::MINUS, TokenType::STAR, TokenType::PLUS};
 
     if (TokenType found_token; check(unary_ops, sizeof(unary_ops) / sizeof(TokenType), found_token))
     {
-        auto line = advance().line; 
-        return std::make_unique<AST::Unary>(line, found_token, parse_unary()); 
+        auto location = advance().location; 
+        const auto operand = run_with_stack([&] { return parse_unary(); });
+        return nodes->make<AST::Unary>(location, found_token, operand);
     }
 
     return parse_postfix(); 
@@ -429,9 +420,9 @@ AST::ExprVariant Parser::parse_unary()
 AST::ExprVariant Parser::parse_postfix()
 {
     // make sure that we dont accidentally parse a variable as a function call
-    if (check(TokenType::IDENTIFIER) && peek().value != "printf" && current_tok + 1 < tokens.size() && tokens[current_tok + 1].type == TokenType::LEFT_PAREN)
+    if (check(TokenType::IDENTIFIER) && peek().symbol != Symbol::PRINTF && tokens.peek(1).type == TokenType::LEFT_PAREN)
     {
-        auto id = advance(); 
+        const auto id = advance(); 
         expect(TokenType::LEFT_PAREN, "Expected ( after function name in function call.");
 
         std::vector<AST::ExprVariant> args;
@@ -440,11 +431,11 @@ AST::ExprVariant Parser::parse_postfix()
             // get the arg first, then loop back for the next one if possible
             do 
             {
-                args.push_back(parse_assignment()); // get each arg (expression)
+                args.push_back(run_with_stack([&] { return parse_assignment(); })); // get each arg (expression)
             } while (check(TokenType::COMMA) && advance().type == TokenType::COMMA); // the second arg is just for cleanliness purposes
         }
         expect(TokenType::RIGHT_PAREN, "Expected ) after function arguments in function call.");
-        return std::make_unique<AST::Call>(id.line, id, std::move(args));
+        return nodes->make<AST::Call>(id.location, id.symbol, nodes->make_list(args));
     }
 
     return parse_primary(); // lowest level to go
@@ -455,44 +446,49 @@ AST::ExprVariant Parser::parse_primary()
     if (check(TokenType::NUMBER) || check(TokenType::STRING))
     {
         const auto val = advance();
-        AST::Literal literal(0, 0);
-
         if (val.type == TokenType::STRING)
         {
-            literal = AST::Literal(val.line, val.value);
+            return nodes->make<AST::Literal>(val.location, std::string(val.value));
         }
-        else
+
+        int number = 0;
+        const auto end = val.value.data() + val.value.size();
+        const auto [ptr, ec] = std::from_chars(val.value.data(), end, number);
+        if (ec == std::errc::result_out_of_range)
         {
-            literal = AST::Literal(val.line, std::stoi(val.value));
+            panic("Integer literal out of range", val.location);
         }
-
-        return literal;
+        else if (ec != std::errc() || ptr != end)
+        {
+            // the lexer also takes "1.5", there are no float literals yet
+            panic("Malformed integer literal", val.location);
+        }
+        return nodes->make<AST::Literal>(val.location, number);
     }
     else if (check(TokenType::IDENTIFIER))
     {
         const auto val = advance();
-        AST::Variable v{val.line, val};
-        return v;
+        return nodes->make<AST::Variable>(val.location, val.symbol);
     }
     else
     {
         const auto offender = advance();  // get the offending token
-        panic("Failed to parse expression!", offender.line);
-        return AST::Literal(0, 0);
+        panic("Failed to parse expression!", offender.location);
+        return nodes->make<AST::Literal>(offender.location, 0);
     }
 }
 
-void Parser::panic(const std::string& why, const std::size_t line) const
+void Parser::panic(const std::string& why, SourceLocation location) const
 {
     std::ostringstream ss; 
-    ss << "Parsing failed! " << why << " on line: " << line << ".\n";
+    ss << "Parsing failed! " << why << " on line: " << tokens.get_lines().lookup(location) << ".\n";
     report_err(std::cout, ss.str());
 }
 
 
 bool Parser::check(const TokenType t) const
 {
-    if (tokens[current_tok].type == t) 
+    if (peek().type == t) 
     {
         return true;
     }
@@ -505,9 +501,9 @@ bool Parser::check(TokenType* types, std::size_t len, TokenType& found) const
 {
     for (std::size_t i = 0; i < len; ++i)
     {
-        if (tokens[current_tok].type == types[i]) 
+        if (peek().type == types[i]) 
         {
-            found = tokens[current_tok].type;
+            found = peek().type;
             return true;
         }
     }
@@ -516,12 +512,8 @@ bool Parser::check(TokenType* types, std::size_t len, TokenType& found) const
 }
 
 
-const Token& Parser::advance()
+Token Parser::advance()
 {
-    if (current_tok < tokens.size() - 1)
-    {
-        return tokens[current_tok++]; 
-    }
-    
-    return tokens[tokens.size() - 1];
+    // the stream stays on END_OF_FILE once it got there
+    return tokens.advance();
 }
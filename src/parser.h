@@ -2,31 +2,74 @@
 #define PARSER_H
 
 #include "ast.h"
+#include "token_stream.h"
 #include "util.h"
 
 struct TreePrinter : AST::ExprVisitor
 {
+    TreePrinter(const AST::Nodes& nodes, const Interner& names) : nodes(nodes), names(names)
+    {
+    }
+
+    const AST::Nodes& nodes;
+    const Interner& names;
     size_t indent_level = 0; 
     void indent();
 
-    virtual void operator()(std::unique_ptr<AST::Binary>&) override;
-    virtual void operator()(const AST::Literal&) override;
-    virtual void operator()(std::unique_ptr<AST::Unary>&) override;
-    virtual void operator()(std::unique_ptr<AST::Assignment>&) override;
-    virtual void operator()(std::unique_ptr<AST::Call>&) override;
-    virtual void operator()(const AST::Variable&) override;
-    virtual void operator()(std::unique_ptr<AST::StructAccess>&) override;
-    virtual void operator()(std::unique_ptr<AST::ArrayAccess>&) override;
+    virtual void operator()(AST::Ref<AST::Binary>) override;
+    virtual void operator()(AST::Ref<AST::Literal>) override;
+    virtual void operator()(AST::Ref<AST::Unary>) override;
+    virtual void operator()(AST::Ref<AST::Assignment>) override;
+    virtual void operator()(AST::Ref<AST::Call>) override;
+    virtual void operator()(AST::Ref<AST::Variable>) override;
+    virtual void operator()(AST::Ref<AST::StructAccess>) override;
+    virtual void operator()(AST::Ref<AST::ArrayAccess>) override;
+};
+
+// counts the nodes of a program by variant kind (indices follow the variant alternatives). every node the
+// parser makes ends up in the tree, so that's the size of each kind's array
+struct NodeCounter
+{
+    std::size_t expressions[std::variant_size_v<AST::ExprVariant>] = {};
+    std::size_t statements[std::variant_size_v<AST::StatementVariant>] = {};
+    std::size_t declarations[std::variant_size_v<AST::DeclarationVariant>] = {};
+
+    // names of the alternatives, in variant order
+    static constexpr const char* expression_names[] = {
+        "Unary", "Literal", "Binary", "Assignment", "Call", "Variable", "StructAccess", "ArrayAccess"
+    };
+    static constexpr const char* statement_names[] = {
+        "BlockStatement", "PrintStatement", "VariableDecl", "ReturnStatement", "ExpressionStatement",
+        "IfElseStatement", "WhileStatement"
+    };
+    static constexpr const char* declaration_names[] = {"FunctionDeclaration"};
+    static_assert(std::size(expression_names) == std::variant_size_v<AST::ExprVariant>);
+    static_assert(std::size(statement_names) == std::variant_size_v<AST::StatementVariant>);
+    static_assert(std::size(declaration_names) == std::variant_size_v<AST::DeclarationVariant>);
+
+    void count(const AST::TranslationUnit& program);
+
+    std::size_t total() const;
 };
 
 class Parser
 {
 public:
-    explicit Parser(const std::vector<Token>& tokens) : tokens(tokens)
+    // parses tokens lexed up front
+    explicit Parser(const TokenBuffer& tokens) : tokens(tokens)
+    {
+    }
+
+    // parses tokens[begin, end) as if they were the whole file, see TokenStream
+    Parser(const TokenBuffer& tokens, std::size_t begin, std::size_t end) : tokens(tokens, begin, end)
+    {
+    }
+
+    // pulls the tokens from the lexer as it goes, only a few of them exist at any time
+    explicit Parser(Lexer& lexer) : tokens(lexer)
     {
-        int a = 3;
     }
-    using Program = std::vector<AST::DeclarationVariant>;
+    using Program = AST::TranslationUnit;
 
     // statements
     Program get_program();
@@ -43,44 +86,35 @@ public:
     AST::StatementVariant parse_while_statement(); 
     
     //AST::ExprVariant get_program();
-    AST::ExprVariant parse_assignment();
-    AST::ExprVariant parse_logic_or();   
-    AST::ExprVariant parse_logic_and();
-    AST::ExprVariant parse_equality();
-    AST::ExprVariant parse_relational();
-    AST::ExprVariant parse_additive();
-    AST::ExprVariant parse_multiplicative();
+    // a full expression, assignments included
+    AST::ExprVariant parse_assignment() { return parse_expression(0); }
+    // an expression whose infix operators all bind tighter than min_power (see binding_powers in parser.cpp)
+    AST::ExprVariant parse_expression(std::uint8_t min_power);
     AST::ExprVariant parse_unary();
     AST::ExprVariant parse_postfix();        // for call, array, struct access: (), [], .
     AST::ExprVariant parse_primary();        // for literals, identifiers, grouped expressions
 
-    void panic(const std::string& why, std::size_t line) const;
+    void panic(const std::string& why, SourceLocation location) const;
     bool check(TokenType t) const;
-    const Token& expect(TokenType t, const std::string& error);
+    Token expect(TokenType t, const std::string& error);
     // checks if the token can represent the start of a initialization for a var
     bool is_type(const Token& tok);
     // check for various types of tokens in an array of any kind
     bool check(TokenType* t, std::size_t len, TokenType& found) const;
-    const Token& advance();
-    Token peek() const { return tokens[current_tok < tokens.size() ? current_tok : tokens.size() - 1]; }
+    Token advance();
+    // valid until the next advance()
+    const Token& peek() const { return tokens.peek(); }
 private:
-    const std::vector<Token>& tokens;
-    size_t current_tok = 0;
+    TokenStream tokens;
+    // the nodes of the unit get_program() is filling
+    AST::Nodes* nodes = nullptr;
     bool is_panic = false;
 
     template<typename Variant>
-    inline size_t get_line(const Variant& node)
+    inline SourceLocation get_location(const Variant& node) const
     {
-        return std::visit([]<typename T0>(const T0& value) -> size_t {
-            using T = std::decay_t<T0>; // get the base type
-            if constexpr (std::is_same_v<T, AST::Literal> || std::is_same_v<T, AST::Variable>)
-            {
-                return value.line;
-            }
-            else
-            {
-                return value->line;
-            }
+        return std::visit([&](auto ref) -> SourceLocation {
+            return (*nodes)[ref].location;
         }, node);
     }
 };
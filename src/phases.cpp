@@ -0,0 +1,129 @@
+#include "phases.h"
+
+#include "llvm/Support/Format.h"
+
+PhaseTracker::Scope::Scope(PhaseTracker& tracker, const std::string& name, const std::string& description)
+    : tracker(tracker), description(description), start(get_allocation_counters()),
+      time(tracker.get_timer(name, description)), trace(description)
+{
+}
+
+PhaseTracker::Scope::~Scope()
+{
+    if (tracker.options.mem_report)
+    {
+        tracker.record_memory(description, start);
+    }
+}
+
+PhaseTracker::PhaseTracker(const Options& options)
+    : options(options)
+{
+    if (options.mem_report)
+    {
+        set_allocation_counting(true);
+    }
+
+    if (!options.time_trace_path.empty())
+    {
+        llvm::timeTraceProfilerInitialize(options.time_trace_granularity, "mini-c");
+    }
+}
+
+PhaseTracker::~PhaseTracker()
+{
+    if (options.mem_report)
+    {
+        set_allocation_counting(false);
+    }
+
+    if (llvm::timeTraceProfilerEnabled())
+    {
+        llvm::timeTraceProfilerCleanup();
+    }
+}
+
+void PhaseTracker::print_report(llvm::raw_ostream& to)
+{
+    if (options.time_report)
+    {
+        // reset, otherwise the group prints everything a second time when it is destroyed
+        timers.print(to, true);
+    }
+
+    if (options.mem_report)
+    {
+        AllocationCounters total;
+        for (const auto& record : memory)
+        {
+            total.allocations += record.allocated.allocations;
+            total.bytes += record.allocated.bytes;
+        }
+
+        to << "===" << std::string(73, '-') << "===\n"
+           << std::string(25, ' ') << "mini-c memory report\n"
+           << "===" << std::string(73, '-') << "===\n"
+           << "  Total: " << total.allocations << " allocations, " << total.bytes << " bytes\n\n"
+           << "   Allocations           Bytes      Peak RSS (KiB)  --- Name ---\n";
+
+        for (const auto& record : memory)
+        {
+            to << llvm::format("  %12llu  %14llu  %16zu", record.allocated.allocations,
+                               record.allocated.bytes, record.peak_rss / 1024)
+               << "  " << record.description << "\n";
+        }
+        to << "\n";
+    }
+}
+
+bool PhaseTracker::write_time_trace()
+{
+    if (!llvm::timeTraceProfilerEnabled())
+    {
+        return true;
+    }
+
+    if (auto err = llvm::timeTraceProfilerWrite(options.time_trace_path, options.time_trace_path))
+    {
+        llvm::errs() << "couldn't write time trace: " << llvm::toString(std::move(err)) << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+void PhaseTracker::record_memory(const std::string& description, const AllocationCounters& start)
+{
+    const auto now = get_allocation_counters();
+    const AllocationCounters allocated = {now.allocations - start.allocations, now.bytes - start.bytes};
+
+    for (auto& record : memory)
+    {
+        if (record.description == description)
+        {
+            record.allocated.allocations += allocated.allocations;
+            record.allocated.bytes += allocated.bytes;
+            record.peak_rss = get_peak_rss();
+            return;
+        }
+    }
+
+    memory.push_back({description, allocated, get_peak_rss()});
+}
+
+llvm::Timer* PhaseTracker::get_timer(const std::string& name, const std::string& description)
+{
+    if (!options.time_report)
+    {
+        return nullptr;
+    }
+
+    // a phase that runs more than once (e.g. once per declaration) accumulates into the same timer
+    for (auto& timer : phase_timers)
+    {
+        if (timer->getName() == name) return timer.get();
+    }
+
+    phase_timers.push_back(std::make_unique<llvm::Timer>(name, description, timers));
+    return phase_timers.back().get();
+}
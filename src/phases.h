@@ -0,0 +1,74 @@
+#ifndef PHASES_H
+#define PHASES_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "memstats.h"
+
+// per-phase accounting for the driver (--time-report, --mem-report, --time-trace); phases are timed with
+// llvm's timers and time trace profiler, so the reports read like clang's -ftime-report and -ftime-trace
+class PhaseTracker
+{
+public:
+    struct Options
+    {
+        bool time_report = false;
+        bool mem_report = false;
+        // chrome trace event json is written here when set
+        std::string time_trace_path;
+        // spans shorter than this (in microseconds) are left out of the trace
+        unsigned time_trace_granularity = 500;
+    };
+
+    // accounts everything between construction and destruction to one phase
+    class Scope
+    {
+    public:
+        Scope(PhaseTracker& tracker, const std::string& name, const std::string& description);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        PhaseTracker& tracker;
+        std::string description;
+        AllocationCounters start;
+        // last, so the timer doesn't include the bookkeeping above
+        llvm::TimeRegion time;
+        llvm::TimeTraceScope trace;
+    };
+
+    explicit PhaseTracker(const Options& options);
+    ~PhaseTracker();
+
+    void print_report(llvm::raw_ostream& to);
+    // false (after reporting why) if the trace couldn't be written
+    bool write_time_trace();
+
+private:
+    // nullptr when time reporting is off, which makes the TimeRegion a no-op
+    llvm::Timer* get_timer(const std::string& name, const std::string& description);
+
+    void record_memory(const std::string& description, const AllocationCounters& start);
+
+private:
+    struct MemoryRecord
+    {
+        std::string description;
+        AllocationCounters allocated; // by this phase alone
+        std::size_t peak_rss = 0;     // of the process, as of the end of the phase
+    };
+
+    Options options;
+    std::vector<MemoryRecord> memory;
+    llvm::TimerGroup timers{"minic", "mini-c compilation time report"};
+    // declared after the group, so they're gone before it is
+    std::vector<std::unique_ptr<llvm::Timer>> phase_timers;
+};
+
+#endif // PHASES_H
@@ -0,0 +1,115 @@
+#include "remarks.h"
+
+#include <iostream>
+#include <optional>
+
+#include "llvm/IR/DiagnosticHandler.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMRemarkStreamer.h"
+#include "llvm/Support/Regex.h"
+#include "llvm/Support/WithColor.h"
+#include "error.h"
+
+namespace
+{
+    // passes ask the handler whether anyone wants their remarks before building them, so the filters
+    // live here and not just in handleDiagnostics
+    struct RemarkHandler : llvm::DiagnosticHandler
+    {
+        std::optional<llvm::Regex> passed, missed, analysis;
+
+        static bool matches(const std::optional<llvm::Regex>& filter, llvm::StringRef pass)
+        {
+            return filter && filter->match(pass);
+        }
+
+        bool isPassedOptRemarkEnabled(llvm::StringRef pass) const override { return matches(passed, pass); }
+        bool isMissedOptRemarkEnabled(llvm::StringRef pass) const override { return matches(missed, pass); }
+        bool isAnalysisRemarkEnabled(llvm::StringRef pass) const override { return matches(analysis, pass); }
+        bool isAnyRemarkEnabled() const override { return passed || missed || analysis; }
+
+        bool handleDiagnostics(const llvm::DiagnosticInfo& info) override
+        {
+            const auto remark = llvm::dyn_cast<llvm::DiagnosticInfoOptimizationBase>(&info);
+            if (!remark)
+            {
+                return false; // not ours, llvm prints it
+            }
+
+            // the yaml streamer sees every remark, only print the ones the filters asked for
+            if (!remark->isEnabled())
+            {
+                return true;
+            }
+
+            auto& to = llvm::errs();
+            if (remark->isLocationAvailable())
+            {
+                to << remark->getLocationStr() << ": ";
+            }
+            else
+            {
+                // no line table (or the instruction lost its location), the function is the best we have
+                to << remark->getFunction().getName() << ": ";
+            }
+
+            const char* flag = remark->isPassed() ? "-Rpass" : remark->isMissed() ? "-Rpass-missed" : "-Rpass-analysis";
+            llvm::WithColor(to, llvm::HighlightColor::Remark) << "remark: ";
+            to << remark->getMsg() << " [" << flag << "=" << remark->getPassName() << "]\n";
+            return true;
+        }
+    };
+
+    // false (after reporting it) if the regex doesn't compile
+    bool set_filter(std::optional<llvm::Regex>& filter, const std::string& pattern, const char* flag)
+    {
+        if (pattern.empty())
+        {
+            return true;
+        }
+
+        filter.emplace(pattern);
+        std::string why;
+        if (!filter->isValid(why))
+        {
+            report_err(std::cout, std::string("invalid regex for ") + flag + " '" + pattern + "': " + why);
+            return false;
+        }
+        return true;
+    }
+}
+
+bool Remarks::install(llvm::LLVMContext& context, const Options& options)
+{
+    auto handler = std::make_unique<RemarkHandler>();
+    if (!set_filter(handler->passed, options.passed, "-Rpass") ||
+        !set_filter(handler->missed, options.missed, "-Rpass-missed") ||
+        !set_filter(handler->analysis, options.analysis, "-Rpass-analysis"))
+    {
+        return false;
+    }
+    context.setDiagnosticHandler(std::move(handler));
+
+    if (!options.yaml_path.empty())
+    {
+        // no pass filter: the yaml file gets everything, it's meant to be sliced by tools afterwards
+        auto file = llvm::setupLLVMOptimizationRemarks(context, options.yaml_path, "", "yaml", false);
+        if (!file)
+        {
+            report_err(std::cout, "couldn't write remarks to " + options.yaml_path + ": " + llvm::toString(file.takeError()));
+            return false;
+        }
+        yaml = std::move(*file);
+    }
+
+    return true;
+}
+
+void Remarks::finish()
+{
+    if (yaml)
+    {
+        yaml->keep();
+    }
+}
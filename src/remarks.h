@@ -0,0 +1,36 @@
+#ifndef REMARKS_H
+#define REMARKS_H
+
+#include <memory>
+#include <string>
+
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/Support/ToolOutputFile.h"
+
+// optimization remarks for the driver: -Rpass=<regex> style filters print the remarks of matching passes
+// as "file:line:col: remark: ..." diagnostics, and --remarks-yaml=<file> records every remark as yaml
+// (the format opt-viewer and llvm-remark-size-diff read)
+class Remarks
+{
+public:
+    struct Options
+    {
+        // regexes over pass names (e.g. "inline", "loop-vectorize|loop-unroll"), empty = off
+        std::string passed;
+        std::string missed;
+        std::string analysis;
+        std::string yaml_path;
+
+        bool enabled() const { return !passed.empty() || !missed.empty() || !analysis.empty() || !yaml_path.empty(); }
+    };
+
+    // installs the remark handler on the context; false (after reporting why) for a bad regex or yaml file
+    bool install(llvm::LLVMContext& context, const Options& options);
+    // keeps the yaml file, it's deleted otherwise (like a half-written object file)
+    void finish();
+
+private:
+    std::unique_ptr<llvm::ToolOutputFile> yaml;
+};
+
+#endif // REMARKS_H
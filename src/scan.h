@@ -0,0 +1,130 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+// vectorized inner loops of the lexer: each one extends a run of bytes (whitespace, identifier characters,
+// digits, everything but a terminator) 32 (avx2) or 16 (sse2) bytes at a time, with a scalar loop for the
+// tail and for targets without either. all of them take and return offsets into the source.
+
+#include <bit>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace scan
+{
+    constexpr bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+    constexpr bool is_digit(char c) { return c >= '0' && c <= '9'; }
+    constexpr bool is_alnum(char c) { return is_digit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+    namespace detail
+    {
+#if defined(__AVX2__)
+        using Block = __m256i;
+        constexpr std::size_t width = 32;
+        inline Block load(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        inline Block eq(Block b, char c) { return _mm256_cmpeq_epi8(b, _mm256_set1_epi8(c)); }
+        // signed compares, fine for the ascii ranges we ask about (bytes >= 0x80 are never in them)
+        inline Block in_range(Block b, char lo, char hi)
+        {
+            return _mm256_and_si256(_mm256_cmpgt_epi8(b, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                                    _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), b));
+        }
+        inline Block either(Block a, Block b) { return _mm256_or_si256(a, b); }
+        inline std::uint32_t bits(Block b) { return static_cast<std::uint32_t>(_mm256_movemask_epi8(b)); }
+#elif defined(__SSE2__)
+        using Block = __m128i;
+        constexpr std::size_t width = 16;
+        inline Block load(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+        inline Block eq(Block b, char c) { return _mm_cmpeq_epi8(b, _mm_set1_epi8(c)); }
+        inline Block in_range(Block b, char lo, char hi)
+        {
+            return _mm_and_si128(_mm_cmpgt_epi8(b, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                                 _mm_cmpgt_epi8(_mm_set1_epi8(static_cast<char>(hi + 1)), b));
+        }
+        inline Block either(Block a, Block b) { return _mm_or_si128(a, b); }
+        inline std::uint32_t bits(Block b) { return static_cast<std::uint32_t>(_mm_movemask_epi8(b)); }
+#endif
+
+        // advances while run(block) marks bytes as part of the run (scalar: keep(c))
+        template <typename Run, typename Keep>
+        inline std::size_t extend(std::string_view s, std::size_t i, Run run, Keep keep)
+        {
+#if defined(__AVX2__) || defined(__SSE2__)
+            constexpr std::uint32_t all = static_cast<std::uint32_t>((std::uint64_t{1} << width) - 1);
+            for (; i + width <= s.size(); i += width)
+            {
+                const std::uint32_t stop = ~bits(run(load(s.data() + i))) & all;
+                if (stop)
+                {
+                    return i + std::countr_zero(stop);
+                }
+            }
+#endif
+            for (; i < s.size() && keep(s[i]); ++i)
+            {
+            }
+            return i;
+        }
+    }
+
+    // offset of the first non-whitespace byte at or after i
+    inline std::size_t skip_whitespace(std::string_view s, std::size_t i)
+    {
+#if defined(__AVX2__) || defined(__SSE2__)
+        const auto run = [](detail::Block b)
+        {
+            return detail::either(detail::either(detail::eq(b, ' '), detail::eq(b, '\t')),
+                                  detail::either(detail::eq(b, '\r'), detail::eq(b, '\n')));
+        };
+#else
+        const auto run = nullptr;
+#endif
+        return detail::extend(s, i, run, is_space);
+    }
+
+    // offset of the first byte after i that isn't [A-Za-z0-9]
+    inline std::size_t skip_alnum(std::string_view s, std::size_t i)
+    {
+#if defined(__AVX2__) || defined(__SSE2__)
+        const auto run = [](detail::Block b)
+        {
+            return detail::either(detail::in_range(b, '0', '9'),
+                                  detail::either(detail::in_range(b, 'a', 'z'), detail::in_range(b, 'A', 'Z')));
+        };
+#else
+        const auto run = nullptr;
+#endif
+        return detail::extend(s, i, run, is_alnum);
+    }
+
+    inline std::size_t skip_digits(std::string_view s, std::size_t i)
+    {
+#if defined(__AVX2__) || defined(__SSE2__)
+        const auto run = [](detail::Block b) { return detail::in_range(b, '0', '9'); };
+#else
+        const auto run = nullptr;
+#endif
+        return detail::extend(s, i, run, is_digit);
+    }
+
+    // offset of the first c at or after i (s.size() if there is none)
+    inline std::size_t find(std::string_view s, std::size_t i, char c)
+    {
+#if defined(__AVX2__) || defined(__SSE2__)
+        // everything but c continues the run: the bytes where the comparison against c came out zero
+        const auto run = [c](detail::Block b)
+        {
+            const detail::Block match = detail::eq(b, c);
+            return detail::eq(match, static_cast<char>(0));
+        };
+#else
+        const auto run = nullptr;
+#endif
+        return detail::extend(s, i, run, [c](char x) { return x != c; });
+    }
+}
+
+#endif // SCAN_H
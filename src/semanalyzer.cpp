@@ -7,8 +7,9 @@
 
 #include "error.h"
 #include "parser.h"
+#include "llvm/Support/TimeProfiler.h"
 
-bool SemanticAnalyzer::is_binary_op_valid(const TokenType operation, const std::string& left_t, const std::string& right_t) const
+bool SemanticAnalyzer::is_binary_op_valid(const TokenType operation, const AST::Type left_t, const AST::Type right_t) const
 {
     const auto range = binary_operations_rules_LUT.equal_range(operation);
     // key doesn't exist ig
@@ -30,7 +31,7 @@ bool SemanticAnalyzer::is_binary_op_valid(const TokenType operation, const std::
     return false;
 }
 
-bool SemanticAnalyzer::is_unary_op_valid(const TokenType operation, const std::string& right_t) const
+bool SemanticAnalyzer::is_unary_op_valid(const TokenType operation, const AST::Type right_t) const
 {
     const auto range = unary_operations_rules_LUT.equal_range(operation);
     if (range.first == range.second)
@@ -50,8 +51,9 @@ bool SemanticAnalyzer::is_unary_op_valid(const TokenType operation, const std::s
     return false;
 }
 
-std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(std::unique_ptr<AST::PrintStatement>& statement)
+std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(AST::Ref<AST::PrintStatement> ref)
 {
+    auto* statement = &nodes[ref];
     auto [ok, s] = perform_analysis(statement->value);
     if (!ok)
     {
@@ -59,19 +61,20 @@ std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(std::unique_pt
         return {false, AST::StatementVariant{}};
     }
 
-    if (AST::get_type(s) != "const char*")
+    if (AST::get_type(nodes, s) != AST::Type::CSTRING)
     {
         report_err(std::cout, "Expected string in print statement!");
         return {false, AST::StatementVariant{}};
     }
 
     // add rich information
-    statement->value = std::move(s);
-    return {ok, std::move(statement)};
+    statement->value = s;
+    return {ok, ref};
 }
 
-std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(std::unique_ptr<AST::VariableDecl>& statement)
+std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(AST::Ref<AST::VariableDecl> ref)
 {
+    auto* statement = &nodes[ref];
     auto [ok, s] = perform_analysis(statement->value);
     if (!ok)
     {
@@ -79,13 +82,13 @@ std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(std::unique_pt
     }
 
     // TODO: check if there is a valid type with structs and stuff
-    if (!types.contains(statement->type) && statement->type != "void")
+    if (!types.contains(statement->type) && statement->type != AST::Type::VOID)
     {
         report_err(std::cout, "Compiler todo: support more types. for int are supported");
         return {false, AST::StatementVariant{}};
     }
 
-    if (AST::get_type(s) != statement->type)
+    if (AST::get_type(nodes, s) != statement->type)
     {
         report_err(std::cout, "Expected matching types in variable declaration");
         return {false, AST::StatementVariant{}};
@@ -97,35 +100,41 @@ std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(std::unique_pt
         return x.name == statement->name;
     });
 
+    ++counters.variable_lookups;
+    counters.variable_probes += std::distance(declared_variables.begin(), duplicate_exists) + (duplicate_exists != declared_variables.end());
+
     if (duplicate_exists != declared_variables.end())
     {
         report_err(std::cout, "Expected a non-duplicate identifier for a variable.");
         return {false, AST::StatementVariant{}};
     }
 
+    ++counters.variables_declared;
     declared_variables.emplace_back(statement->name, current_scope_depth);
     declared_variable_types[statement->name] = statement->type;
     // add the $$$
-    statement->value = std::move(s);
-    return {true, std::move(statement)};
+    statement->value = s;
+    return {true, ref};
 }
 
-std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(std::unique_ptr<AST::ExpressionStatement>& statement)
+std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(AST::Ref<AST::ExpressionStatement> ref)
 {
+    auto* statement = &nodes[ref];
     auto [ok, e] = perform_analysis(statement->expr); // pretty simple for this, mostly handled by other routines
     if (!ok)
     {
         return {false, AST::StatementVariant{}};
     }
 
-    statement->expr = std::move(e); // add richer info $$$$$$
-    return {true, std::move(statement)};
+    statement->expr = e; // add richer info $$$$$$
+    return {true, ref};
 }
 
-std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(std::unique_ptr<AST::IfElseStatement>& statement)
+std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(AST::Ref<AST::IfElseStatement> ref)
 {
+    auto* statement = &nodes[ref];
     auto [ok, rich_condition] = perform_analysis(statement->condition);
-    if (!ok || AST::get_type(rich_condition) != "int")
+    if (!ok || AST::get_type(nodes, rich_condition) != AST::Type::INT)
     {
         report_err(std::cout, "Expected a integer as the condition for if condition!");
         return {false, AST::StatementVariant{}};
@@ -143,17 +152,18 @@ std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(std::unique_pt
         return {false, AST::StatementVariant{}};
     }
 
-    statement->condition = std::move(rich_condition); 
-    statement->if_body = std::move(rich_if_body);
-    statement->else_body = std::move(rich_else_body);
+    statement->condition = rich_condition; 
+    statement->if_body = rich_if_body;
+    statement->else_body = rich_else_body;
 
-    return {true, std::move(statement)};
+    return {true, ref};
 }
 
-std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(std::unique_ptr<AST::WhileStatement>& s)
+std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(AST::Ref<AST::WhileStatement> ref)
 {
+    auto* s = &nodes[ref];
     auto [ok, rich_condition] = perform_analysis(s->condition);
-    if (!ok || AST::get_type(rich_condition) != "int")
+    if (!ok || AST::get_type(nodes, rich_condition) != AST::Type::INT)
     {
         report_err(std::cout, "Expected a integer as the condition for while condition!");
         return {false, AST::StatementVariant{}};
@@ -165,25 +175,28 @@ std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(std::unique_pt
         return {false, AST::StatementVariant{}};
     }
 
-    s->condition = std::move(rich_condition); 
-    s->body = std::move(rich_body);
+    s->condition = rich_condition; 
+    s->body = rich_body;
 
-    return {true, std::move(s)};
+    return {true, ref};
 }
 
-std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(std::unique_ptr<AST::BlockStatement>& statement)
+std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(AST::Ref<AST::BlockStatement> ref)
 {
+    auto* statement = &nodes[ref];
     ++current_scope_depth;
+    ++counters.scope_pushes;
 
-    for (auto &st : statement->statements)
+    for (auto& st : nodes[statement->statements])
     {
         auto [ok, s] = perform_analysis(st);
         if (!ok) return {false, AST::StatementVariant{}};
 
-        st = std::move(s);
+        st = s;
     }
 
     --current_scope_depth;
+    counters.scope_exit_scans += declared_variables.size();
     // STL so goated; filter out the bad variables
     const auto new_end = std::remove_if(declared_variables.begin(), declared_variables.end(), [&](auto& x) -> bool
     {
@@ -194,124 +207,144 @@ std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(std::unique_pt
     // remove
     declared_variables.erase(new_end, declared_variables.end());
     
-    return {true, std::move(statement)};
+    return {true, ref};
 }
 
-std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(AST::Literal& lit) const
+std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(AST::Ref<AST::Literal> ref)
 {
     // just add type info, not much else needed
+    auto& lit = nodes[ref];
     lit.result_type = AST::get_literal_type(lit);
-    return std::make_pair(true, std::move(lit));
+    return {true, ref};
 }
 
-std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(AST::Variable& var)
+std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(AST::Ref<AST::Variable> ref)
 {
+    auto& var = nodes[ref];
     const auto found_variable = std::find_if(declared_variables.begin(), declared_variables.end(), [&](auto& x) -> bool
     {
-        return x.name == var.name.value;
+        return x.name == var.name;
     });
 
+    ++counters.variable_lookups;
+    counters.variable_probes += std::distance(declared_variables.begin(), found_variable) + (found_variable != declared_variables.end());
+
     // second check just to keep scopes, might be redundant tbh
-    if (found_variable == declared_variables.end() && found_variable->scope_depth > current_scope_depth)
+    if (found_variable == declared_variables.end() || found_variable->scope_depth > current_scope_depth)
     {
         std::ostringstream ss;
-        ss << "undefined variable: " << var.name.value << "\n";
+        ss << "undefined variable: " << names.spelling(var.name) << "\n";
         report_err(std::cout, ss.str());
-        return {false, AST::Literal{0, 0}};
+        return {false, AST::ExprVariant{}};
     }
 
-    var.result_type = declared_variable_types[var.name.value];
-    return {true, var};
+    var.result_type = declared_variable_types[var.name];
+    return {true, ref};
 }
 
-std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(std::unique_ptr<AST::Binary>& bin)
+std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(AST::Ref<AST::Binary> ref)
 {
+    auto* bin = &nodes[ref];
     auto [l_ok, expr_1] = perform_analysis(bin->left);
     auto [r_ok, expr_2] = perform_analysis(bin->right);
 
     // if lower analysis failed
     if (!l_ok || !r_ok)
     {
-        return {false, AST::Literal{0, 0}};
+        return {false, AST::ExprVariant{}};
     }
     // look up the operation and see if it's not valid
-    if (!is_binary_op_valid(bin->op, AST::get_type(expr_1), AST::get_type(expr_2)))
+    if (!is_binary_op_valid(bin->op, AST::get_type(nodes, expr_1), AST::get_type(nodes, expr_2)))
     {
         std::ostringstream ss;
-        ss << "Semantic analysis failed! Non matching types on binary operation in line: " << bin->line << "\n";
+        ss << "Semantic analysis failed! Non matching types on binary operation in line: " << lines.lookup(bin->location) << "\n";
         report_err(std::cout, ss.str());
-        return {false, AST::Literal{0, 0}};
+        return {false, AST::ExprVariant{}};
     }
 
     // update the tree with rich info
-    bin->left = std::move(expr_1);
-    bin->right = std::move(expr_2);
+    bin->left = expr_1;
+    bin->right = expr_2;
     // TODO: upcasting
-    bin->result_type = AST::get_type(bin->left); // for further analysis
-    return {true, std::move(bin)};
+    bin->result_type = AST::get_type(nodes, bin->left); // for further analysis
+    return {true, ref};
 }
 
-std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(std::unique_ptr<AST::Unary>& un)
+std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(AST::Ref<AST::Unary> ref)
 {
+    auto* un = &nodes[ref];
     auto [ok, expr] = perform_analysis(un->operand);
     if (!ok)
     {
-        return {false, AST::Literal{0, 0}}; // failed somewhere down lower in the tree
+        return {false, AST::ExprVariant{}}; // failed somewhere down lower in the tree
     }
 
-    if (!is_unary_op_valid(un->op, AST::get_type(expr)))
+    if (!is_unary_op_valid(un->op, AST::get_type(nodes, expr)))
     {
         std::ostringstream ss;
-        ss << "Semantic analysis failed! Non matching types on unary operation in line: " << un->line << "\n";
+        ss << "Semantic analysis failed! Non matching types on unary operation in line: " << lines.lookup(un->location) << "\n";
         report_err(std::cout, ss.str());
-        return {false, AST::Literal{0, 0}};
+        return {false, AST::ExprVariant{}};
     }
 
-    un->operand = std::move(expr);
-    un->result_type = AST::get_type(un->operand); // for now
-    return {true, std::move(un)};
+    un->operand = expr;
+    un->result_type = AST::get_type(nodes, un->operand); // for now
+    return {true, ref};
 }
 
-std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(std::unique_ptr<AST::Assignment>& asn)
+std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(AST::Ref<AST::Assignment> ref)
 {
+    auto* asn = &nodes[ref];
     auto [lhs_ok, lhs_expr] = perform_analysis(asn->lhs);
     auto [rhs_ok, rhs_expr] = perform_analysis(asn->rhs);
 
     if (!lhs_ok || !rhs_ok)
     {
-        return {false, AST::Literal{0, 0}};
+        return {false, AST::ExprVariant{}};
     }
 
-    if (get_type(lhs_expr) != get_type(rhs_expr))
+    if (AST::get_type(nodes, lhs_expr) != AST::get_type(nodes, rhs_expr))
     {
         std::ostringstream ss;
-        ss << "Cannot match types in assignment expression on line: " << asn->line << "\n";
+        ss << "Cannot match types in assignment expression on line: " << lines.lookup(asn->location) << "\n";
         report_err(std::cout, ss.str());
-        return {false, AST::Literal{0, 0}};
+        return {false, AST::ExprVariant{}};
     }
 
     if (!is_storable_location(lhs_expr))
     {
         report_err(std::cout, "Assignment must be to a writable location.\n");
-        return {false, AST::Literal{0, 0}};
+        return {false, AST::ExprVariant{}};
+    }
+
+    // a += b has to be a valid a + b too
+    if (const auto op = compound_operator(asn->op); op != TokenType::END_OF_FILE
+        && !is_binary_op_valid(op, AST::get_type(nodes, lhs_expr), AST::get_type(nodes, rhs_expr)))
+    {
+        std::ostringstream ss;
+        ss << "Semantic analysis failed! Non matching types on compound assignment in line: " << lines.lookup(asn->location) << "\n";
+        report_err(std::cout, ss.str());
+        return {false, AST::ExprVariant{}};
     }
 
-    asn->lhs = std::move(lhs_expr);
-    asn->rhs = std::move(rhs_expr);
-    asn->result_type = get_type(asn->lhs);
-    return {true, std::move(asn)};
+    asn->lhs = lhs_expr;
+    asn->rhs = rhs_expr;
+    asn->result_type = AST::get_type(nodes, asn->lhs);
+    return {true, ref};
 }
 
-std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(std::unique_ptr<AST::Call>& call)
+std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(AST::Ref<AST::Call> ref)
 {
-    const auto found_function = declared_functions.find(call->func_name.value); 
+    auto* call = &nodes[ref];
+    ++counters.function_lookups;
+    const auto found_function = declared_functions.find(call->func_name); 
     // Check if the function exists
     if (found_function == declared_functions.end())
     {
         std::ostringstream ss;
-        ss << "Function not declared: " << call->func_name.value << "\n";
+        ss << "Function not declared: " << names.spelling(call->func_name) << "\n";
         report_err(std::cout, ss.str());
-        return {false, AST::Literal{0, 0}};
+        return {false, AST::ExprVariant{}};
     }
 
     // Check that the number of arguments in the call matches the number of parameters
@@ -319,50 +352,55 @@ std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(std::unique_ptr<AST:
     if (call->args.size() != proto.param_types.size())
     {
         std::ostringstream ss;
-        ss << "Function call argument count mismatch for function: " << call->func_name.value << "\n";
+        ss << "Function call argument count mismatch for function: " << names.spelling(call->func_name) << "\n";
         report_err(std::cout, ss.str());
-        return {false, AST::Literal{0, 0}};
+        return {false, AST::ExprVariant{}};
     }
 
     // Check that each argument type is compatible with its corresponding parameter type
-    for (auto i = 0; i < call->args.size(); ++i)
+    const auto args = nodes[call->args];
+    for (auto i = 0; i < args.size(); ++i)
     {
-        auto [ok, rich_arg] = perform_analysis(call->args[i]);
+        auto [ok, rich_arg] = perform_analysis(args[i]);
         if (!ok)
         {
-            return {false, AST::Literal{0, 0}};
+            return {false, AST::ExprVariant{}};
         }
 
-        if (AST::get_type(rich_arg) != proto.param_types[i])
+        if (AST::get_type(nodes, rich_arg) != proto.param_types[i])
         {
             std::ostringstream ss;
-            ss << "Function call argument type mismatch for function: " << call->func_name.value << " at argument index " << i << "\n";
+            ss << "Function call argument type mismatch for function: " << names.spelling(call->func_name) << " at argument index " << i << "\n";
             report_err(std::cout, ss.str());
-            return {false, AST::Literal{0, 0}};
+            return {false, AST::ExprVariant{}};
         }
 
         // update with rich info
-        call->args[i] = std::move(rich_arg);
+        args[i] = rich_arg;
     }
 
     // Check that the call’s return value is used appropriately 
     call->result_type = proto.return_type; 
 
-    return {true, std::move(call)};
+    return {true, ref};
 }
 
-std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(const std::unique_ptr<AST::StructAccess>& sa)
+std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(AST::Ref<AST::StructAccess> ref)
 {
 }
 
-std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(const std::unique_ptr<AST::ArrayAccess>& aa)
+std::pair<bool, AST::ExprVariant> SemanticAnalyzer::analyze(AST::Ref<AST::ArrayAccess> ref)
 {
 }
 
-std::pair<bool, AST::DeclarationVariant> SemanticAnalyzer::danalyze(std::unique_ptr<AST::FunctionDeclaration> &declaration)
+std::pair<bool, AST::DeclarationVariant> SemanticAnalyzer::danalyze(AST::Ref<AST::FunctionDeclaration> ref)
 {
-    current_function = declaration.get(); // for substatements to access
+    auto* declaration = &nodes[ref];
+    // one span per function in --time-trace output (free when tracing is off)
+    llvm::TimeTraceScope trace("SemanticAnalyzer::danalyze", names.spelling(declaration->name));
+    current_function = declaration; // for substatements to access
 
+    ++counters.function_lookups;
     auto duplicate_exists = declared_functions.find(declaration->name); // make sure no dup functions exist
     if (duplicate_exists != declared_functions.end())
     {
@@ -370,8 +408,8 @@ std::pair<bool, AST::DeclarationVariant> SemanticAnalyzer::danalyze(std::unique_
         return {false, AST::DeclarationVariant{}};
     }
 
-    std::vector<std::string> param_types;
-    for (auto& [ty, name] : declaration->params) 
+    std::vector<AST::Type> param_types;
+    for (auto& [ty, name] : nodes[declaration->params]) 
     {
         param_types.push_back(ty);
     }
@@ -379,8 +417,8 @@ std::pair<bool, AST::DeclarationVariant> SemanticAnalyzer::danalyze(std::unique_
     FunctionPrototype proto = {declaration->return_type, std::move(param_types)};
     declared_functions.insert({declaration->name, proto});
 
-    std::unordered_set<std::string> param_names; 
-    for (auto& [ty, name] : declaration->params) 
+    std::unordered_set<Symbol> param_names; 
+    for (auto& [ty, name] : nodes[declaration->params]) 
     {
         if (param_names.contains(name)) 
         {
@@ -390,6 +428,7 @@ std::pair<bool, AST::DeclarationVariant> SemanticAnalyzer::danalyze(std::unique_
         
         param_names.insert(name);
         // simulate variable scoping behavior for usage in the function body (gets removed by block filtering later)
+        ++counters.variables_declared;
         declared_variables.push_back({name, current_scope_depth + 1});
         declared_variable_types[name] = ty;
 
@@ -406,7 +445,7 @@ std::pair<bool, AST::DeclarationVariant> SemanticAnalyzer::danalyze(std::unique_
         return {false, AST::DeclarationVariant{}};
     }
 
-    auto as_statement = AST::StatementVariant{std::move(declaration->body)};
+    auto as_statement = AST::StatementVariant{declaration->body};
     auto [ok, rich_body] = perform_analysis(as_statement);
     if (!ok)
     {
@@ -415,13 +454,13 @@ std::pair<bool, AST::DeclarationVariant> SemanticAnalyzer::danalyze(std::unique_
 
     current_function = nullptr; 
     // update with rich information
-    declaration->body = std::move(std::get<std::unique_ptr<AST::BlockStatement>>(rich_body));
+    declaration->body = std::get<AST::Ref<AST::BlockStatement>>(rich_body);
     
     // ensure there is at least one return statement (is this correct? no. I don't care)
     bool found_return = false;
-    for (auto& statement : declaration->body->statements)
+    for (auto& statement : nodes[nodes[declaration->body].statements])
     {
-        if (std::holds_alternative<std::unique_ptr<AST::ReturnStatement>>(statement)) 
+        if (std::holds_alternative<AST::Ref<AST::ReturnStatement>>(statement)) 
         {
             found_return = true;
             break;
@@ -429,17 +468,18 @@ std::pair<bool, AST::DeclarationVariant> SemanticAnalyzer::danalyze(std::unique_
 
     }
 
-    if (declaration->return_type != "void" && !found_return)
+    if (declaration->return_type != AST::Type::VOID && !found_return)
     {
         report_err(std::cout, "Non-void function must have at least one return statement!");
         return {false, AST::DeclarationVariant{}};
     }
     
-    return {true, std::move(declaration)};
+    return {true, ref};
 }
 
-std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(std::unique_ptr<AST::ReturnStatement> &statement)
+std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(AST::Ref<AST::ReturnStatement> ref)
 {
+    auto* statement = &nodes[ref];
     if (statement->value.has_value())
     {
         auto [ok, rich_expr] = perform_analysis(statement->value.value());
@@ -448,19 +488,19 @@ std::pair<bool, AST::StatementVariant> SemanticAnalyzer::sanalyze(std::unique_pt
             return {false, AST::StatementVariant{}};
         }
 
-        if (AST::get_type(rich_expr) != current_function->return_type)
+        if (AST::get_type(nodes, rich_expr) != current_function->return_type)
         {
             report_err(std::cout, "Return type does not match function return type!");
             return {false, AST::StatementVariant{}};
         }
 
-        statement->value = std::move(rich_expr);
+        statement->value = rich_expr;
     }
-    else if (current_function->return_type != "void")
+    else if (current_function->return_type != AST::Type::VOID)
     {
         report_err(std::cout, "Non-void function must return a value!");
         return {false, AST::StatementVariant{}};
     }
 
-    return {true, std::move(statement)};
+    return {true, ref};
 }
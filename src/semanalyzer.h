@@ -1,114 +1,141 @@
 #ifndef SEMANALYZER_H
 #define SEMANALYZER_H
 
+#include <unordered_map>
 #include <unordered_set>
 #include "ast.h"
+#include "stack.h"
 
 class SemanticAnalyzer
 {
 public:
     struct FunctionPrototype
     {
-        std::string return_type;
-        std::vector<std::string> param_types; // only types are needed for checking
+        AST::Type return_type;
+        std::vector<AST::Type> param_types; // only types are needed for checking
     }; 
 
-    explicit SemanticAnalyzer() = default;
+    // symbol table traffic, reported by --stats
+    struct Counters
+    {
+        std::size_t variable_lookups = 0;
+        std::size_t variable_probes = 0; // declared_variables entries compared by those lookups
+        std::size_t variables_declared = 0;
+        std::size_t function_lookups = 0;
+        std::size_t scope_pushes = 0;
+        std::size_t scope_exit_scans = 0; // declared_variables entries visited when leaving blocks
+    };
+
+    // analyzes (and fills in the types of) the nodes of one translation unit. names and lines are only needed
+    // for spelling identifiers and locations in diagnostics
+    SemanticAnalyzer(AST::Nodes& nodes, const Interner& names, const LineTable& lines)
+        : nodes(nodes), names(names), lines(lines)
+    {
+    }
+
+    const Counters& get_counters() const { return counters; }
 
+    // expressions and statements nest, see stack.h
     auto perform_analysis(AST::ExprVariant& variant)
     {
-        return std::visit([&](auto& v)
+        return run_with_stack([&]
         {
-            return analyze(v);
-        }, variant);
+            return std::visit([&](auto v)
+            {
+                return analyze(v);
+            }, variant);
+        });
     }
 
     auto perform_analysis(AST::StatementVariant& variant)
     {
-        return std::visit([&](auto& v)
+        return run_with_stack([&]
         {
-            return sanalyze(v);
-        }, variant);
+            return std::visit([&](auto v)
+            {
+                return sanalyze(v);
+            }, variant);
+        });
     }
 
     auto perform_analysis(AST::DeclarationVariant& variant) 
     {
-        return std::visit([&](auto& v)
+        return std::visit([&](auto v)
         {
             return danalyze(v); 
         }, variant); 
     }
 private:
-    bool is_binary_op_valid(TokenType operation, const std::string& left_t, const std::string& right_t) const;
-    bool is_unary_op_valid(TokenType operation, const std::string& right_t) const;
+    bool is_binary_op_valid(TokenType operation, AST::Type left_t, AST::Type right_t) const;
+    bool is_unary_op_valid(TokenType operation, AST::Type right_t) const;
     // check whether the area is writable memory
     // TODO: support pointers??
-    bool is_storable_location(AST::ExprVariant& variant) const
+    bool is_storable_location(const AST::ExprVariant& variant) const
     {
-        return std::visit([&]<typename T0>(T0&& x)
-        {
-            using T = std::decay_t<T0>;
-            if (std::is_same_v<T, AST::Variable>)
-            {
-                return true;
-            }
-
-            return false;
-        }, variant);
+        return std::holds_alternative<AST::Ref<AST::Variable>>(variant);
     }
 
     // declaration analyze
-    std::pair<bool, AST::DeclarationVariant> danalyze(std::unique_ptr<AST::FunctionDeclaration>& declaration);
+    std::pair<bool, AST::DeclarationVariant> danalyze(AST::Ref<AST::FunctionDeclaration> ref);
 
     // statement analyze
-    std::pair<bool, AST::StatementVariant> sanalyze(std::unique_ptr<AST::ReturnStatement>& statement);
-    std::pair<bool, AST::StatementVariant> sanalyze(std::unique_ptr<AST::PrintStatement>& statement);
-    std::pair<bool, AST::StatementVariant> sanalyze(std::unique_ptr<AST::VariableDecl>& statement);
-    std::pair<bool, AST::StatementVariant> sanalyze(std::unique_ptr<AST::ExpressionStatement>& statement);
-    std::pair<bool, AST::StatementVariant> sanalyze(std::unique_ptr<AST::IfElseStatement>& statement);
-    std::pair<bool, AST::StatementVariant> sanalyze(std::unique_ptr<AST::WhileStatement>& statement);
-    std::pair<bool, AST::StatementVariant> sanalyze(std::unique_ptr<AST::BlockStatement>& statement);
+    std::pair<bool, AST::StatementVariant> sanalyze(AST::Ref<AST::ReturnStatement> ref);
+    std::pair<bool, AST::StatementVariant> sanalyze(AST::Ref<AST::PrintStatement> ref);
+    std::pair<bool, AST::StatementVariant> sanalyze(AST::Ref<AST::VariableDecl> ref);
+    std::pair<bool, AST::StatementVariant> sanalyze(AST::Ref<AST::ExpressionStatement> ref);
+    std::pair<bool, AST::StatementVariant> sanalyze(AST::Ref<AST::IfElseStatement> ref);
+    std::pair<bool, AST::StatementVariant> sanalyze(AST::Ref<AST::WhileStatement> ref);
+    std::pair<bool, AST::StatementVariant> sanalyze(AST::Ref<AST::BlockStatement> ref);
     
-    std::pair<bool, AST::ExprVariant> analyze(AST::Literal& lit) const;
-    std::pair<bool, AST::ExprVariant> analyze(AST::Variable& var);
-    std::pair<bool, AST::ExprVariant> analyze(std::unique_ptr<AST::Binary>& bin);
-    std::pair<bool, AST::ExprVariant> analyze(std::unique_ptr<AST::Unary>& un);
-    std::pair<bool, AST::ExprVariant> analyze(std::unique_ptr<AST::Assignment>& asn);
-    std::pair<bool, AST::ExprVariant> analyze(std::unique_ptr<AST::Call>& call);
-    std::pair<bool, AST::ExprVariant> analyze(const std::unique_ptr<AST::StructAccess>& sa);
-    std::pair<bool, AST::ExprVariant> analyze(const std::unique_ptr<AST::ArrayAccess>& aa);
+    std::pair<bool, AST::ExprVariant> analyze(AST::Ref<AST::Literal> ref);
+    std::pair<bool, AST::ExprVariant> analyze(AST::Ref<AST::Variable> ref);
+    std::pair<bool, AST::ExprVariant> analyze(AST::Ref<AST::Binary> ref);
+    std::pair<bool, AST::ExprVariant> analyze(AST::Ref<AST::Unary> ref);
+    std::pair<bool, AST::ExprVariant> analyze(AST::Ref<AST::Assignment> ref);
+    std::pair<bool, AST::ExprVariant> analyze(AST::Ref<AST::Call> ref);
+    std::pair<bool, AST::ExprVariant> analyze(AST::Ref<AST::StructAccess> ref);
+    std::pair<bool, AST::ExprVariant> analyze(AST::Ref<AST::ArrayAccess> ref);
 
 private:
     struct Variable
     {
-        std::string name;
+        Symbol name;
         std::size_t scope_depth = static_cast<std::size_t>(-1);
     };
 
+    AST::Nodes& nodes;
+    const Interner& names;
+    const LineTable& lines;
     AST::FunctionDeclaration* current_function = nullptr;
     std::vector<Variable> declared_variables;
-    std::unordered_map<std::string, std::string> declared_variable_types;
-    std::unordered_set<std::string> types = {"int", "void"}; // supported types
-    std::unordered_map<std::string, FunctionPrototype> declared_functions; 
+    std::unordered_map<Symbol, AST::Type> declared_variable_types;
+    std::unordered_set<AST::Type> types = {AST::Type::INT, AST::Type::VOID}; // supported types
+    std::unordered_map<Symbol, FunctionPrototype> declared_functions; 
     std::size_t current_scope_depth = 0;
+    Counters counters;
 
     // store grammar rules
-    const std::unordered_multimap<TokenType, std::pair<std::string, std::string>>
+    const std::unordered_multimap<TokenType, std::pair<AST::Type, AST::Type>>
         binary_operations_rules_LUT = {
-            {TokenType::PLUS, {"int", "int"}},
-            {TokenType::MINUS, {"int", "int"}},
-            {TokenType::EQUAL_EQUAL, {"int", "int"}},
-            {TokenType::BANG_EQUAL, {"int", "int"}}, 
-            {TokenType::LESS, {"int", "int"}},
-            {TokenType::GREATER, {"int", "int"}},
-            {TokenType::LESS_EQUAL, {"int", "int"}},    
-            {TokenType::GREATER_EQUAL, {"int", "int"}},
+            {TokenType::PLUS, {AST::Type::INT, AST::Type::INT}},
+            {TokenType::MINUS, {AST::Type::INT, AST::Type::INT}},
+            {TokenType::STAR, {AST::Type::INT, AST::Type::INT}},
+            {TokenType::SLASH, {AST::Type::INT, AST::Type::INT}},
+            {TokenType::PERCENT, {AST::Type::INT, AST::Type::INT}},
+            {TokenType::EQUAL_EQUAL, {AST::Type::INT, AST::Type::INT}},
+            {TokenType::BANG_EQUAL, {AST::Type::INT, AST::Type::INT}}, 
+            {TokenType::LESS, {AST::Type::INT, AST::Type::INT}},
+            {TokenType::GREATER, {AST::Type::INT, AST::Type::INT}},
+            {TokenType::LESS_EQUAL, {AST::Type::INT, AST::Type::INT}},    
+            {TokenType::GREATER_EQUAL, {AST::Type::INT, AST::Type::INT}},
+            {TokenType::AND, {AST::Type::INT, AST::Type::INT}},
+            {TokenType::OR, {AST::Type::INT, AST::Type::INT}},
         };
 
-    const std::unordered_multimap<TokenType, std::string>
+    const std::unordered_multimap<TokenType, AST::Type>
         unary_operations_rules_LUT = {
-            {TokenType::MINUS, "int"},
-            {TokenType::PLUS, "int"}
+            {TokenType::MINUS, AST::Type::INT},
+            {TokenType::PLUS, AST::Type::INT}
     };
 };
 
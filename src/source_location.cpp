@@ -0,0 +1,28 @@
+#include "source_location.h"
+
+#include <algorithm>
+#include <cstring>
+
+std::ostream& operator<<(std::ostream& to, LineColumn where)
+{
+    return to << where.line << ":" << where.column;
+}
+
+LineColumn LineTable::lookup(SourceLocation location) const
+{
+    std::call_once(built, [this]
+    {
+        line_starts.push_back(0);
+        const char* const begin = source.data();
+        const char* const end = begin + source.size();
+        for (const char* p = begin; p < end && (p = static_cast<const char*>(std::memchr(p, '\n', end - p))); ++p)
+        {
+            line_starts.push_back(static_cast<std::uint32_t>(p + 1 - begin));
+        }
+    });
+
+    // the last line starting at or before the offset
+    const auto next = std::upper_bound(line_starts.begin(), line_starts.end(), location.offset);
+    const auto line = static_cast<std::uint32_t>(next - line_starts.begin());
+    return LineColumn{line, location.offset - *(next - 1) + 1};
+}
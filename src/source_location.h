@@ -0,0 +1,47 @@
+#ifndef SOURCE_LOCATION_H
+#define SOURCE_LOCATION_H
+
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+// where a token or AST node starts: a byte offset into the source (sources are limited to 4 GiB). lines and
+// columns are only worked out when something is reported, through a LineTable
+struct SourceLocation
+{
+    std::uint32_t offset = 0;
+};
+
+// 1-based, the column counts bytes
+struct LineColumn
+{
+    std::uint32_t line = 1;
+    std::uint32_t column = 1;
+};
+
+// "line:column"
+std::ostream& operator<<(std::ostream& to, LineColumn where);
+
+// offsets to lines and columns. the line starts are found the first time one is asked for (which can be
+// from several threads at once), a source that never has anything reported never pays for it
+class LineTable
+{
+public:
+    // the source has to outlive the table
+    explicit LineTable(std::string_view source) : source(source)
+    {
+    }
+    LineTable(const LineTable&) = delete;
+    LineTable& operator=(const LineTable&) = delete;
+
+    LineColumn lookup(SourceLocation location) const;
+
+private:
+    std::string_view source;
+    mutable std::once_flag built;
+    mutable std::vector<std::uint32_t> line_starts;
+};
+
+#endif // SOURCE_LOCATION_H
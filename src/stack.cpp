@@ -0,0 +1,75 @@
+#include "stack.h"
+#include "error.h"
+
+#include <cstddef>
+
+#include "llvm/Support/thread.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+namespace
+{
+    // what run_on_new_stack() gives its threads: a lot of levels per hop, and it's only address space until used
+    constexpr unsigned new_stack_size = 64 << 20;
+    // kept free at the end of every stack, for the frames between two checks and whatever llvm and libc call below
+    constexpr std::size_t headroom = 256 << 10;
+    // stacks whose size we can't ask for are assumed to be at least this big from where they were first checked
+    constexpr std::size_t assumed_stack_size = 512 << 10;
+
+    const char* current_frame()
+    {
+        return static_cast<const char*>(__builtin_frame_address(0));
+    }
+
+    // the lowest address this thread's frames may reach (stacks grow down on everything we build for)
+    const char* find_limit()
+    {
+#if defined(__linux__)
+        pthread_attr_t attributes;
+        if (pthread_getattr_np(pthread_self(), &attributes) == 0)
+        {
+            void* lowest = nullptr;
+            std::size_t size = 0;
+            const bool found = pthread_attr_getstack(&attributes, &lowest, &size) == 0;
+            pthread_attr_destroy(&attributes);
+            if (found && size > headroom)
+            {
+                return static_cast<const char*>(lowest) + headroom;
+            }
+        }
+#elif defined(__APPLE__)
+        const auto self = pthread_self();
+        const auto size = pthread_get_stacksize_np(self);
+        if (size > headroom)
+        {
+            return static_cast<const char*>(pthread_get_stackaddr_np(self)) - size + headroom;
+        }
+#endif
+        return current_frame() - (assumed_stack_size - headroom);
+    }
+
+    thread_local const char* limit = nullptr;
+}
+
+bool stack_nearly_exhausted()
+{
+    if (!limit)
+    {
+        limit = find_limit();
+    }
+    return current_frame() < limit;
+}
+
+void run_on_new_stack(llvm::function_ref<void()> fn)
+{
+    // errors are collected per thread, the new one reports into whatever this one would have
+    ErrorCapture* const capture = ErrorCapture::active();
+    llvm::thread helper(llvm::Optional<unsigned>(new_stack_size), [&]
+    {
+        ErrorCapture::set_active(capture);
+        fn();
+    });
+    helper.join();
+}
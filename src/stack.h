@@ -0,0 +1,31 @@
+#ifndef STACK_H
+#define STACK_H
+
+#include <optional>
+#include <type_traits>
+#include "llvm/ADT/STLFunctionalExtras.h"
+
+// nesting in the source (long operator chains, blocks in blocks, calls in calls) is recursion in the parser, sema
+// and codegen. they go through run_with_stack() once per level, which carries on on a fresh thread with a stack
+// of its own when this one runs low, so generated code can nest as deep as memory allows
+
+// whether this thread's stack is down to the headroom kept for the frames between two checks
+bool stack_nearly_exhausted();
+
+// runs fn on a new thread with a big stack and waits for it. errors it reports land where this thread's would
+void run_on_new_stack(llvm::function_ref<void()> fn);
+
+template <typename Fn>
+std::invoke_result_t<Fn&> run_with_stack(Fn&& fn)
+{
+    if (!stack_nearly_exhausted()) [[likely]]
+    {
+        return fn();
+    }
+
+    std::optional<std::invoke_result_t<Fn&>> result;
+    run_on_new_stack([&] { result.emplace(fn()); });
+    return std::move(*result);
+}
+
+#endif // STACK_H
@@ -0,0 +1,134 @@
+#include "stats.h"
+
+#include <algorithm>
+
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
+
+void Statistics::add(const std::string& group, const std::string& name, const std::uint64_t n)
+{
+    const auto found = std::find_if(entries.begin(), entries.end(), [&](const Entry& e)
+    {
+        return e.group == group && e.name == name;
+    });
+
+    if (found != entries.end())
+    {
+        found->value += n;
+        return;
+    }
+
+    entries.push_back({group, name, n});
+}
+
+void Statistics::collect(const Lexer::Counters& counters)
+{
+    std::uint64_t total = 0;
+    for (const auto n : counters.by_type) total += n;
+
+    add("lexer", "tokens", total);
+    for (std::size_t i = 0; i < std::size(counters.by_type); ++i)
+    {
+        if (counters.by_type[i] != 0)
+        {
+            add("lexer", "tokens." + stringify_token_type(static_cast<TokenType>(i)), counters.by_type[i]);
+        }
+    }
+}
+
+void Statistics::collect(const Parser::Program& program)
+{
+    NodeCounter counter;
+    counter.count(program);
+
+    add("parser", "nodes", counter.total());
+    for (std::size_t i = 0; i < std::size(counter.declarations); ++i)
+    {
+        if (counter.declarations[i]) add("parser", std::string("nodes.") + NodeCounter::declaration_names[i], counter.declarations[i]);
+    }
+    for (std::size_t i = 0; i < std::size(counter.statements); ++i)
+    {
+        if (counter.statements[i]) add("parser", std::string("nodes.") + NodeCounter::statement_names[i], counter.statements[i]);
+    }
+    for (std::size_t i = 0; i < std::size(counter.expressions); ++i)
+    {
+        if (counter.expressions[i]) add("parser", std::string("nodes.") + NodeCounter::expression_names[i], counter.expressions[i]);
+    }
+}
+
+void Statistics::collect(const SemanticAnalyzer::Counters& counters)
+{
+    add("sema", "variable-lookups", counters.variable_lookups);
+    add("sema", "variable-lookup-probes", counters.variable_probes);
+    add("sema", "variables-declared", counters.variables_declared);
+    add("sema", "function-lookups", counters.function_lookups);
+    add("sema", "scope-pushes", counters.scope_pushes);
+    add("sema", "scope-exit-scans", counters.scope_exit_scans);
+}
+
+void Statistics::collect(const llvm::Module& mod)
+{
+    std::uint64_t functions = 0, blocks = 0, instructions = 0, allocas = 0, loads = 0, stores = 0, calls = 0;
+    for (const auto& f : mod)
+    {
+        if (f.isDeclaration()) continue;
+
+        ++functions;
+        for (const auto& bb : f)
+        {
+            ++blocks;
+            for (const auto& inst : bb)
+            {
+                ++instructions;
+                allocas += llvm::isa<llvm::AllocaInst>(inst);
+                loads += llvm::isa<llvm::LoadInst>(inst);
+                stores += llvm::isa<llvm::StoreInst>(inst);
+                calls += llvm::isa<llvm::CallInst>(inst);
+            }
+        }
+    }
+
+    add("codegen", "functions", functions);
+    add("codegen", "basic-blocks", blocks);
+    add("codegen", "instructions", instructions);
+    add("codegen", "allocas", allocas);
+    add("codegen", "loads", loads);
+    add("codegen", "stores", stores);
+    add("codegen", "calls", calls);
+}
+
+void Statistics::print(llvm::raw_ostream& to) const
+{
+    std::size_t value_width = 0, group_width = 0;
+    for (const auto& e : entries)
+    {
+        value_width = std::max(value_width, std::to_string(e.value).size());
+        group_width = std::max(group_width, e.group.size());
+    }
+
+    to << "===" << std::string(73, '-') << "===\n"
+       << std::string(26, ' ') << "... Statistics Collected ...\n"
+       << "===" << std::string(73, '-') << "===\n\n";
+
+    for (const auto& e : entries)
+    {
+        to << llvm::format("%*llu %-*s - %s\n", static_cast<int>(value_width), e.value,
+                           static_cast<int>(group_width), e.group.c_str(), e.name.c_str());
+    }
+    to << "\n";
+}
+
+void Statistics::write_json(llvm::raw_ostream& to) const
+{
+    llvm::json::OStream json(to, 2);
+    json.object([&]
+    {
+        for (const auto& e : entries)
+        {
+            json.attribute(e.group + "." + e.name, static_cast<int64_t>(e.value));
+        }
+    });
+    to << "\n";
+}
@@ -0,0 +1,45 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/raw_ostream.h"
+#include "lexer.h"
+#include "parser.h"
+#include "semanalyzer.h"
+
+namespace llvm
+{
+    class Module;
+}
+
+// named counters, grouped by the phase that produced them (--stats, --stats-json)
+class Statistics
+{
+public:
+    void add(const std::string& group, const std::string& name, std::uint64_t n = 1);
+
+    void collect(const Lexer::Counters& counters);
+    void collect(const Parser::Program& program);
+    void collect(const SemanticAnalyzer::Counters& counters);
+    void collect(const llvm::Module& mod);
+
+    // same layout as llvm's -stats
+    void print(llvm::raw_ostream& to) const;
+    // a flat {"group.name": value} object, like llvm's -stats-json
+    void write_json(llvm::raw_ostream& to) const;
+
+private:
+    struct Entry
+    {
+        std::string group;
+        std::string name;
+        std::uint64_t value = 0;
+    };
+
+    std::vector<Entry> entries; // in the order they were first added
+};
+
+#endif // STATS_H
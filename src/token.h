@@ -0,0 +1,138 @@
+#ifndef TOKEN_H
+#define TOKEN_H
+
+#include <cstdint>
+#include <string_view>
+#include "interner.h"
+#include "source_location.h"
+
+enum class TokenType : std::uint8_t {
+    // Single-character tokens
+    LEFT_PAREN,     // (
+    RIGHT_PAREN,    // )
+    LEFT_BRACE,     // {
+    RIGHT_BRACE,    // }
+    COMMA,          // ,
+    DOT,            // .
+    SEMICOLON,      // ;
+    PLUS,           // +
+    MINUS,          // -
+    STAR,           // *
+    SLASH,          // /
+    PERCENT,        // %
+    LEFT_SBRACKET,
+    RIGHT_SBRACKET, 
+    // One or two character tokens
+    BANG,           // !
+    BANG_EQUAL,     // !=
+    EQUAL,          // =
+    EQUAL_EQUAL,    // ==
+    GREATER,        // >
+    GREATER_EQUAL,  // >=
+    LESS,           // <
+    LESS_EQUAL,     // <=
+    PLUS_EQUAL,     // +=
+    MINUS_EQUAL,    // -=
+    STAR_EQUAL,     // *=
+    SLASH_EQUAL,    // /=
+    PERCENT_EQUAL,  // %=
+    AND, 
+    OR,
+
+    // Literals
+    IDENTIFIER,
+    NUMBER,
+    STRING,
+
+    // Keywords
+    IF,
+    ELSE,
+    WHILE,
+    FOR,
+    RETURN,
+    INT,
+    CHAR,
+    VOID,
+    STRUCT,
+    BREAK,
+    CONTINUE,
+
+    // End of file
+    END_OF_FILE
+};
+
+
+// value points into the source buffer (or at a static spelling), so the source has to outlive its tokens
+// and everything built from them
+struct Token 
+{
+    TokenType type; 
+    std::string_view value;
+    SourceLocation location; // of the first character
+    Symbol symbol = Symbol::NONE; // identifiers only
+};
+
+// fixed spelling of punctuators and keywords, empty for tokens whose text varies (identifiers, literals, eof)
+constexpr std::string_view token_spelling(const TokenType type)
+{
+    switch (type)
+    {
+    case TokenType::LEFT_PAREN: return "(";
+    case TokenType::RIGHT_PAREN: return ")";
+    case TokenType::LEFT_BRACE: return "{";
+    case TokenType::RIGHT_BRACE: return "}";
+    case TokenType::COMMA: return ",";
+    case TokenType::DOT: return ".";
+    case TokenType::SEMICOLON: return ";";
+    case TokenType::PLUS: return "+";
+    case TokenType::MINUS: return "-";
+    case TokenType::STAR: return "*";
+    case TokenType::SLASH: return "/";
+    case TokenType::PERCENT: return "%";
+    case TokenType::LEFT_SBRACKET: return "[";
+    case TokenType::RIGHT_SBRACKET: return "]";
+    case TokenType::BANG: return "!";
+    case TokenType::BANG_EQUAL: return "!=";
+    case TokenType::EQUAL: return "=";
+    case TokenType::EQUAL_EQUAL: return "==";
+    case TokenType::GREATER: return ">";
+    case TokenType::GREATER_EQUAL: return ">=";
+    case TokenType::LESS: return "<";
+    case TokenType::LESS_EQUAL: return "<=";
+    case TokenType::PLUS_EQUAL: return "+=";
+    case TokenType::MINUS_EQUAL: return "-=";
+    case TokenType::STAR_EQUAL: return "*=";
+    case TokenType::SLASH_EQUAL: return "/=";
+    case TokenType::PERCENT_EQUAL: return "%=";
+    case TokenType::AND: return "&&";
+    case TokenType::OR: return "||";
+    case TokenType::IF: return "if";
+    case TokenType::ELSE: return "else";
+    case TokenType::WHILE: return "while";
+    case TokenType::FOR: return "for";
+    case TokenType::RETURN: return "return";
+    case TokenType::INT: return "int";
+    case TokenType::CHAR: return "char";
+    case TokenType::VOID: return "void";
+    case TokenType::STRUCT: return "struct";
+    case TokenType::BREAK: return "break";
+    case TokenType::CONTINUE: return "continue";
+    default: return "";
+    }
+}
+
+// the binary operator a compound assignment applies (PLUS for +=), END_OF_FILE for any other token
+constexpr TokenType compound_operator(const TokenType type)
+{
+    switch (type)
+    {
+    case TokenType::PLUS_EQUAL: return TokenType::PLUS;
+    case TokenType::MINUS_EQUAL: return TokenType::MINUS;
+    case TokenType::STAR_EQUAL: return TokenType::STAR;
+    case TokenType::SLASH_EQUAL: return TokenType::SLASH;
+    case TokenType::PERCENT_EQUAL: return TokenType::PERCENT;
+    default: return TokenType::END_OF_FILE;
+    }
+}
+
+#endif // TOKEN_H
@@ -0,0 +1,93 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+#include <array>
+#include "lexer.h"
+
+// what the parser reads tokens from: either pulled from a lexer on demand, so only the few tokens of
+// lookahead exist at a time, or read from tokens lexed up front. past the end it keeps yielding END_OF_FILE.
+class TokenStream
+{
+public:
+    // how far peek() can look past the current token
+    static constexpr std::size_t lookahead = 2;
+
+    explicit TokenStream(Lexer& lexer) : lexer(&lexer)
+    {
+        fill();
+    }
+
+    // the tokens have to end in END_OF_FILE, as Lexer::lex() leaves them
+    explicit TokenStream(const TokenBuffer& tokens) : TokenStream(tokens, 0, tokens.size() - 1)
+    {
+    }
+
+    // only the tokens from begin up to end, as if the file ended (END_OF_FILE) where the token at end starts
+    TokenStream(const TokenBuffer& tokens, std::size_t begin, std::size_t end) : tokens(&tokens), next_index(begin), end(end)
+    {
+        fill();
+    }
+
+    // for turning the tokens' locations into lines
+    const LineTable& get_lines() const { return lexer ? lexer->get_lines() : tokens->get_lines(); }
+
+    // the token ahead tokens past the current one; valid until the next advance()
+    const Token& peek(std::size_t ahead = 0) const { return ring[(head + ahead) % capacity]; }
+
+    Token advance()
+    {
+        const Token t = ring[head];
+        head = (head + 1) % capacity;
+        ring[(head + lookahead) % capacity] = pull();
+        return t;
+    }
+
+private:
+    void fill()
+    {
+        for (std::size_t i = 0; i <= lookahead; ++i)
+        {
+            ring[i] = pull();
+        }
+    }
+
+    Token pull()
+    {
+        // END_OF_FILE is sticky, without asking the source again
+        if (done)
+        {
+            return last;
+        }
+
+        if (lexer)
+        {
+            last = lexer->next();
+        }
+        else if (next_index < end)
+        {
+            last = tokens->at(next_index++);
+        }
+        else
+        {
+            last = Token{TokenType::END_OF_FILE, "", tokens->at(end).location};
+        }
+        done = last.type == TokenType::END_OF_FILE;
+        return last;
+    }
+
+private:
+    static constexpr std::size_t capacity = lookahead + 1;
+
+    Lexer* lexer = nullptr;
+    // the cursor into a lexed buffer
+    const TokenBuffer* tokens = nullptr;
+    std::size_t next_index = 0;
+    std::size_t end = 0;
+
+    std::array<Token, capacity> ring;
+    std::size_t head = 0;
+    Token last;
+    bool done = false;
+};
+
+#endif // TOKEN_STREAM_H
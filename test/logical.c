@@ -0,0 +1,52 @@
+int side(int x)
+{
+	return x;
+}
+
+int skipped()
+{
+	printf("evaluated a skipped operand");
+	return 1;
+}
+
+// exits with 0, or with the sum of the checks that failed
+int main()
+{
+	int failed = 0;
+	int a = 1 && 2;
+	if (a != 1)
+	{
+		failed = failed + 1;
+	}
+	else
+	{
+	}
+	int b = 0 || 5;
+	if (b != 1)
+	{
+		failed = failed + 2;
+	}
+	else
+	{
+	}
+	int c = 2 < 3;
+	if (c != 1)
+	{
+		failed = failed + 4;
+	}
+	else
+	{
+	}
+	int d = 1 || skipped();
+	int e = 1 && side(3);
+	int f = 0 && skipped();
+	int g = 0 || side(0);
+	if (d + e + f + g != 2)
+	{
+		failed = failed + 8;
+	}
+	else
+	{
+	}
+	return failed;
+}
@@ -0,0 +1,13 @@
+int main() {
+  // a comment with a " quote
+  printf("multi
+line
+string // not a comment
+");
+  char c = '
+';
+  char d = 'x';
+  int y = 3; // "
+  printf("x\"y");
+  return 0;
+}
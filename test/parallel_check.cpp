@@ -0,0 +1,222 @@
+// checks that ParallelLexer and ParallelParser give exactly what the serial lexer and parser do, over every
+// small chunk size and a few thread counts, so each chunk boundary lands on every line (and every function) of
+// the file at some point
+// usage: minic-parallel-check [--max-chunk N] file...
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "compiler.h"
+#include "error.h"
+#include "interner.h"
+#include "lexer.h"
+#include "parallel_lexer.h"
+#include "parallel_parser.h"
+#include "parser.h"
+#include "semanalyzer.h"
+
+namespace
+{
+    // what a run left behind: lines describing its result (a lexer's tokens, a parser's program) and the
+    // errors, in order
+    struct Outcome
+    {
+        std::vector<std::string> lines;
+        std::vector<std::string> errors;
+    };
+
+    // one line per token: kind, offset and text
+    std::vector<std::string> describe(const TokenBuffer& tokens)
+    {
+        std::vector<std::string> lines;
+        lines.reserve(tokens.size());
+        for (std::size_t i = 0; i < tokens.size(); ++i)
+        {
+            const auto t = tokens.at(i);
+            lines.push_back(stringify_token_type(t.type) + " @" + std::to_string(t.location.offset) + " '" +
+                            std::string(t.value) + "'");
+        }
+        return lines;
+    }
+
+    Outcome lex_serial(const std::string& source)
+    {
+        Interner names;
+        ErrorCapture errors;
+        Lexer lexer(source, names);
+        return {describe(lexer.lex()), errors.get_messages()};
+    }
+
+    Outcome lex_parallel(const std::string& source, const ParallelLexer::Options& options)
+    {
+        Interner names;
+        ErrorCapture errors;
+        ParallelLexer lexer(source, names, options);
+        return {describe(lexer.lex()), errors.get_messages()};
+    }
+
+    // a parsed program: its node counts, then (if it parses and analyzes cleanly) its IR, and the errors of all
+    // three phases in order
+    Outcome describe(Parser::Program program, const Interner& names, const LineTable& lines, ErrorCapture& errors)
+    {
+        Outcome outcome;
+        NodeCounter counter;
+        counter.count(program);
+        outcome.lines.push_back(std::to_string(program.size()) + " declarations");
+        for (std::size_t i = 0; i < std::size(counter.expressions); ++i)
+        {
+            outcome.lines.push_back(NodeCounter::expression_names[i] + (" " + std::to_string(counter.expressions[i])));
+        }
+        for (std::size_t i = 0; i < std::size(counter.statements); ++i)
+        {
+            outcome.lines.push_back(NodeCounter::statement_names[i] + (" " + std::to_string(counter.statements[i])));
+        }
+
+        bool analyzed = !errors.failed();
+        if (analyzed)
+        {
+            SemanticAnalyzer analyzer(program.nodes, names, lines);
+            for (auto& d : program)
+            {
+                auto [ok, rich] = analyzer.perform_analysis(d);
+                d = std::move(rich);
+                analyzed &= ok;
+            }
+        }
+        outcome.lines.push_back(analyzed ? "analyzed" : "not analyzed");
+        if (analyzed && !errors.failed())
+        {
+            Codegen gen(names);
+            gen.generate_translation_unit(program);
+            std::string ir;
+            llvm::raw_string_ostream out(ir);
+            gen.print(out);
+            out.flush();
+            for (std::size_t at = 0; at < ir.size();)
+            {
+                const auto end = std::min(ir.find('\n', at), ir.size());
+                outcome.lines.push_back(ir.substr(at, end - at));
+                at = end + 1;
+            }
+        }
+        outcome.errors = errors.get_messages();
+        return outcome;
+    }
+
+    // Parser over the serial lexer's tokens, or ParallelParser with options
+    Outcome parse(const std::string& source, const ParallelParser::Options* options)
+    {
+        Interner names;
+        ErrorCapture errors;
+        Lexer lexer(source, names);
+        const auto& tokens = lexer.lex();
+        auto program = options ? ParallelParser(tokens, *options).get_program() : Parser(tokens).get_program();
+        return describe(std::move(program), names, lexer.get_lines(), errors);
+    }
+
+    // the first line the two differ at, or -1
+    std::ptrdiff_t first_difference(const std::vector<std::string>& a, const std::vector<std::string>& b)
+    {
+        for (std::size_t i = 0; i < std::max(a.size(), b.size()); ++i)
+        {
+            if (i >= a.size() || i >= b.size() || a[i] != b[i])
+            {
+                return static_cast<std::ptrdiff_t>(i);
+            }
+        }
+        return -1;
+    }
+
+    // prints the first difference, under what; true if there was none
+    bool same(const std::string& what, const std::vector<std::string>& expected, const std::vector<std::string>& got)
+    {
+        const auto at = first_difference(expected, got);
+        if (at < 0)
+        {
+            return true;
+        }
+        const auto line = [](const std::vector<std::string>& lines, std::size_t i) {
+            return i < lines.size() ? lines[i] : std::string("(nothing)");
+        };
+        std::cerr << what << ": differs at #" << at << ", expected " << line(expected, at) << ", got "
+                  << line(got, at) << "\n";
+        return false;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t max_chunk = 64;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--max-chunk" && i + 1 < argc) max_chunk = std::max<std::size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        else if (arg.starts_with("--"))
+        {
+            std::cerr << "Usage: minic-parallel-check [--max-chunk N] file...\n";
+            return 1;
+        }
+        else files.push_back(arg);
+    }
+
+    const unsigned thread_counts[] = {1, 2, 3, 8};
+    bool ok = !files.empty();
+    for (const auto& file : files)
+    {
+        std::ifstream in(file, std::ios::binary);
+        if (!in.is_open())
+        {
+            std::cerr << "minic-parallel-check: couldn't open " << file << "\n";
+            ok = false;
+            continue;
+        }
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        const std::string source = buffer.str();
+
+        const auto serial = lex_serial(source);
+        std::size_t runs = 0;
+        for (const auto threads : thread_counts)
+        {
+            for (std::size_t chunk = 1; chunk <= max_chunk; ++chunk)
+            {
+                const auto parallel = lex_parallel(source, {.threads = threads, .min_chunk = chunk});
+                const auto what = file + " (lexer, " + std::to_string(threads) + " threads, min_chunk " +
+                                  std::to_string(chunk) + ")";
+                ok &= same(what + " tokens", serial.lines, parallel.lines);
+                ok &= same(what + " errors", serial.errors, parallel.errors);
+                ++runs;
+            }
+        }
+
+        // a piece is at least min_chunk tokens, so the same sizes put piece boundaries after every function
+        const auto serial_program = parse(source, nullptr);
+        std::size_t parses = 0;
+        for (const auto threads : thread_counts)
+        {
+            for (std::size_t chunk = 1; chunk <= max_chunk; ++chunk)
+            {
+                const ParallelParser::Options options{.threads = threads, .min_chunk = chunk};
+                const auto parallel = parse(source, &options);
+                const auto what = file + " (parser, " + std::to_string(threads) + " threads, min_chunk " +
+                                  std::to_string(chunk) + ")";
+                ok &= same(what + " program", serial_program.lines, parallel.lines);
+                ok &= same(what + " errors", serial_program.errors, parallel.errors);
+                ++parses;
+            }
+        }
+
+        std::cout << file << ": " << serial.lines.size() << " tokens, " << runs << " parallel lexes, "
+                  << serial_program.errors.size() << " errors, " << parses << " parallel parses\n";
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,30 @@
+int one()
+{
+	return 1;
+}
+
+int two()
+{
+	int a = one();
+	return a + one();
+}
+
+int broken(int x)
+{
+	int y = x +;
+	while (y < 3
+	{
+		y = y + 1;
+	}
+	return y;
+}
+
+int three()
+{
+	return two() + one();
+}
+
+int main()
+{
+	return three();
+}
@@ -0,0 +1,36 @@
+# compiles SOURCE with MINIC (plus FLAGS, a ;-list), runs the module with LLI and fails unless it exits with 0.
+# mini-c prints its banners on stdout too, so the IR is cut out of the output starting at its ModuleID line
+#   cmake -DMINIC=... -DLLI=... -DSOURCE=... [-DFLAGS=...] -DWORK=<scratch file> -P run_program.cmake
+
+execute_process(
+    COMMAND ${MINIC} ${FLAGS} ${SOURCE}
+    OUTPUT_VARIABLE output
+    RESULT_VARIABLE result
+)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "mini-c failed on ${SOURCE}:\n${output}")
+endif()
+
+string(FIND "${output}" "; ModuleID" module_start)
+if (module_start EQUAL -1)
+    message(FATAL_ERROR "no module in mini-c's output for ${SOURCE}:\n${output}")
+endif()
+string(SUBSTRING "${output}" ${module_start} -1 module)
+string(FIND "${module}" "Generating LLVM IR" banner)
+if (NOT banner EQUAL -1)
+    string(SUBSTRING "${module}" 0 ${banner} module)
+    string(FIND "${module}" "\n" line_end REVERSE) # the start of the banner's line
+    string(SUBSTRING "${module}" 0 ${line_end} module)
+endif()
+file(WRITE ${WORK} "${module}")
+
+execute_process(
+    COMMAND ${LLI} ${WORK}
+    OUTPUT_VARIABLE program_output
+    ERROR_VARIABLE program_error
+    RESULT_VARIABLE program_result
+)
+message("${program_output}")
+if (NOT program_result EQUAL 0)
+    message(FATAL_ERROR "${SOURCE} exited with ${program_result}\n${program_error}")
+endif()